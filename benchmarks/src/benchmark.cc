@@ -1,10 +1,14 @@
+#include "column_table.hh"
 #include "file_map.hh"
 #include "json_node.hh"
+#include "json_serializer.hh"
 #include "parsing.hh"
+#include "read_ahead.hh"
 
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <string>
 
 void print_time_elapsed(const std::chrono::time_point<std::chrono::steady_clock>& start, const std::chrono::time_point<std::chrono::steady_clock>& end);
 
@@ -16,12 +20,40 @@ int main(int argc, char* argv[]) {
 	auto end = std::chrono::steady_clock::now();
 	std::cout << "Time elapsed for file parse:\n";
 	print_time_elapsed(start, end);
+	start = std::chrono::steady_clock::now();
+	parse_into(mapping.cbegin(), mapping.cend(), node);
+	end = std::chrono::steady_clock::now();
+	std::cout << "\nTime elapsed for file reparse into existing document:\n";
+	print_time_elapsed(start, end);
+	start = std::chrono::steady_clock::now();
+	{
+		file_stream stream(argv[1]);
+		parse_into(stream.begin(), stream.end(), node);
+	}
+	end = std::chrono::steady_clock::now();
+	std::cout << "\nTime elapsed for pipelined file parse:\n";
+	print_time_elapsed(start, end);
+	start = std::chrono::steady_clock::now();
+	column_table table = parse_columns(mapping.cbegin(), mapping.cend());
+	end = std::chrono::steady_clock::now();
+	std::cout << "\nTime elapsed for columnar file parse:\n";
+	print_time_elapsed(start, end);
+	start = std::chrono::steady_clock::now();
+	const json_column::number_type mean = column_mean(table.get_column("number"));
+	end = std::chrono::steady_clock::now();
+	std::cout << "\nTime elapsed for column mean (" << mean << "):\n";
+	print_time_elapsed(start, end);
 	std::ofstream ofs("/dev/null");
 	start = std::chrono::steady_clock::now();
 	ofs << node;
 	end = std::chrono::steady_clock::now();
 	std::cout << "\nTime elapsed for file write:\n";
 	print_time_elapsed(start, end);
+	start = std::chrono::steady_clock::now();
+	std::string serialized = json_serializer(node).to_string();
+	end = std::chrono::steady_clock::now();
+	std::cout << "\nTime elapsed for parallel serialization (" << serialized.size() << " bytes):\n";
+	print_time_elapsed(start, end);
 	std::cout << "\nPress enter to quit." << std::endl;
 	std::cin.get();
 }
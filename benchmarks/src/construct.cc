@@ -0,0 +1,54 @@
+#include "json_builder.hh"
+#include "json_node.hh"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+void print_time_elapsed(const std::chrono::time_point<std::chrono::steady_clock>& start, const std::chrono::time_point<std::chrono::steady_clock>& end);
+
+int main(int argc, char* argv[]) {
+	using namespace touchstone;
+	const unsigned long records = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+	auto start = std::chrono::steady_clock::now();
+	json_node::array_type arr;
+	for (unsigned long i = 0; i < records; ++i) {
+		json_node::object_type obj;
+		obj["string"] = json_node::string_type("abcdefghijklmnopqrstuvwxyz");
+		obj["number"] = static_cast<json_node::number_type>(i);
+		obj["boolean"] = static_cast<json_node::bool_type>(i & 1);
+		obj["null"] = json_node();
+		arr.push_back(std::move(obj));
+	}
+	json_node copied{std::move(arr)};
+	auto end = std::chrono::steady_clock::now();
+	std::cout << "Time elapsed for construction from temporaries:\n";
+	print_time_elapsed(start, end);
+
+	start = std::chrono::steady_clock::now();
+	json_builder builder;
+	builder.begin_array();
+	for (unsigned long i = 0; i < records; ++i) {
+		builder.begin_object();
+		builder.key("string").value("abcdefghijklmnopqrstuvwxyz");
+		builder.key("number").value(static_cast<json_node::number_type>(i));
+		builder.key("boolean").value(static_cast<json_node::bool_type>(i & 1));
+		builder.key("null").value();
+		builder.end_object();
+	}
+	builder.end_array();
+	json_node built = builder.release();
+	end = std::chrono::steady_clock::now();
+	std::cout << "\nTime elapsed for construction in place:\n";
+	print_time_elapsed(start, end);
+
+	std::cout << "\nDocuments " << (copied.to_string() == built.to_string() ? "match." : "differ!") << std::endl;
+}
+
+void print_time_elapsed(const std::chrono::time_point<std::chrono::steady_clock>& start, const std::chrono::time_point<std::chrono::steady_clock>& end) {
+	std::cout << "--Seconds elapsed:      " << std::chrono::duration_cast<std::chrono::seconds>(end - start).count() << '\n';
+	std::cout << "--Milliseconds elapsed: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << '\n';
+	std::cout << "--Microseconds elapsed: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << '\n';
+	std::cout << "--Nanoseconds elapsed:  " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << '\n';
+}
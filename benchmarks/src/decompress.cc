@@ -0,0 +1,60 @@
+#include "decompress_stream.hh"
+#include "file_map.hh"
+#include "json_node.hh"
+#include "parsing.hh"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+void print_time_elapsed(const std::chrono::time_point<std::chrono::steady_clock>& start, const std::chrono::time_point<std::chrono::steady_clock>& end);
+
+int main(int argc, char* argv[]) {
+	using namespace touchstone;
+	const std::string inflated = std::string(argv[1]) + ".inflated";
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		decompress_stream stream(argv[1]);
+		std::ofstream ofs(inflated, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+		std::copy(stream.begin(), stream.end(), std::ostreambuf_iterator<char>(ofs));
+	}
+	json_node inflated_node;
+	{
+		file_map mapping(inflated);
+		inflated_node = parse(mapping.cbegin(), mapping.cend());
+	}
+	auto end = std::chrono::steady_clock::now();
+	std::remove(inflated.c_str());
+	std::cout << "Time elapsed for decompress-then-parse:\n";
+	print_time_elapsed(start, end);
+
+	start = std::chrono::steady_clock::now();
+	json_node streamed_node;
+	{
+		decompress_stream stream(argv[1]);
+		streamed_node = parse(stream.begin(), stream.end());
+	}
+	end = std::chrono::steady_clock::now();
+	std::cout << "\nTime elapsed for streaming decompress and parse:\n";
+	print_time_elapsed(start, end);
+
+	std::cout << "\nDocuments " << (inflated_node.to_string() == streamed_node.to_string() ? "match." : "differ!") << std::endl;
+
+	// Given the uncompressed original, check the round trip as well.
+	if (argc > 2) {
+		file_map mapping(argv[2]);
+		const json_node original_node = parse(mapping.cbegin(), mapping.cend());
+		std::cout << "Original " << (original_node == streamed_node ? "matches." : "differs!") << std::endl;
+	}
+}
+
+void print_time_elapsed(const std::chrono::time_point<std::chrono::steady_clock>& start, const std::chrono::time_point<std::chrono::steady_clock>& end) {
+	std::cout << "--Seconds elapsed:      " << std::chrono::duration_cast<std::chrono::seconds>(end - start).count() << '\n';
+	std::cout << "--Milliseconds elapsed: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << '\n';
+	std::cout << "--Microseconds elapsed: " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << '\n';
+	std::cout << "--Nanoseconds elapsed:  " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() << '\n';
+}
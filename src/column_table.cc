@@ -0,0 +1,307 @@
+#include "column_table.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace touchstone {
+
+namespace {
+
+bool get_bit(const json_column::bitmap_type& p_bits, const json_column::size_type p_pos) noexcept {
+	return (p_bits[p_pos / 64] >> (p_pos % 64)) & 1;
+}
+
+bool is_integral(const json_node::number_type p_num) noexcept {
+	return std::trunc(p_num) == p_num && std::fabs(p_num) < 9.2e18;
+}
+
+}
+
+// Public json_column member functions:
+
+void json_column::append(const json_node& p_node) {
+	if (p_node.is_null()) {
+		append_null();
+		return;
+	}
+	if (p_node.is_number()) {
+		const number_type num = p_node.get_number();
+		if (m_type == column_type::NONE) set_type(is_integral(num) ? column_type::INTEGER : column_type::NUMBER);
+		if (m_type == column_type::INTEGER && !is_integral(num)) promote();
+		if (m_type == column_type::INTEGER) m_integers.push_back(static_cast<integer_type>(num));
+		else if (m_type == column_type::NUMBER) m_numbers.push_back(num);
+		else throw std::runtime_error{"Invalid type."};
+	} else if (p_node.is_bool()) {
+		if (m_type == column_type::NONE) set_type(column_type::BOOL);
+		if (m_type != column_type::BOOL) throw std::runtime_error{"Invalid type."};
+		push_bit(m_bools, m_size, p_node.get_bool());
+	} else if (p_node.is_string()) {
+		if (m_type == column_type::NONE) set_type(column_type::STRING);
+		if (m_type != column_type::STRING) throw std::runtime_error{"Invalid type."};
+		m_string_data += p_node.get_string();
+		m_string_offsets.push_back(m_string_data.size());
+	} else {
+		throw std::runtime_error{"Invalid type."};
+	}
+	push_bit(m_validity, m_size++, true);
+}
+
+void json_column::append_null() {
+	switch (m_type) {
+		case column_type::INTEGER:
+			m_integers.push_back(0);
+			break;
+		case column_type::NUMBER:
+			m_numbers.push_back(0);
+			break;
+		case column_type::BOOL:
+			push_bit(m_bools, m_size, false);
+			break;
+		case column_type::STRING:
+			m_string_offsets.push_back(m_string_data.size());
+			break;
+		case column_type::NONE:
+			break;
+	}
+	push_bit(m_validity, m_size++, false);
+}
+
+void json_column::reserve(const size_type p_size) {
+	m_validity.reserve((p_size + 63) / 64);
+	switch (m_type) {
+		case column_type::INTEGER:
+			m_integers.reserve(p_size);
+			break;
+		case column_type::NUMBER:
+			m_numbers.reserve(p_size);
+			break;
+		case column_type::BOOL:
+			m_bools.reserve((p_size + 63) / 64);
+			break;
+		case column_type::STRING:
+			m_string_offsets.reserve(p_size + 1);
+			break;
+		case column_type::NONE:
+			break;
+	}
+}
+
+json_column::column_type json_column::type() const noexcept {
+	return m_type;
+}
+
+json_column::size_type json_column::size() const noexcept {
+	return m_size;
+}
+
+bool json_column::is_null(const size_type p_pos) const noexcept {
+	return !get_bit(m_validity, p_pos);
+}
+
+const json_column::bitmap_type& json_column::validity() const noexcept {
+	return m_validity;
+}
+
+const std::vector<json_column::integer_type>& json_column::get_integers() const {
+	if (m_type == column_type::INTEGER) return m_integers;
+	throw std::runtime_error{"Invalid type."};
+}
+
+const std::vector<json_column::number_type>& json_column::get_numbers() const {
+	if (m_type == column_type::NUMBER) return m_numbers;
+	throw std::runtime_error{"Invalid type."};
+}
+
+const json_column::bitmap_type& json_column::get_bools() const {
+	if (m_type == column_type::BOOL) return m_bools;
+	throw std::runtime_error{"Invalid type."};
+}
+
+bool json_column::get_bool(const size_type p_pos) const {
+	return get_bit(get_bools(), p_pos);
+}
+
+const json_column::string_type& json_column::get_string_data() const {
+	if (m_type == column_type::STRING) return m_string_data;
+	throw std::runtime_error{"Invalid type."};
+}
+
+const std::vector<json_column::size_type>& json_column::get_string_offsets() const {
+	if (m_type == column_type::STRING) return m_string_offsets;
+	throw std::runtime_error{"Invalid type."};
+}
+
+json_column::string_type json_column::get_string(const size_type p_pos) const {
+	const auto& offsets = get_string_offsets();
+	return m_string_data.substr(offsets.at(p_pos), offsets.at(p_pos + 1) - offsets[p_pos]);
+}
+
+
+// Private json_column member functions:
+
+// Columns that have only seen nulls so far are untyped, so the rows
+// already appended are backfilled with null slots of the new type.
+
+void json_column::set_type(const column_type p_type) {
+	m_type = p_type;
+	switch (m_type) {
+		case column_type::INTEGER:
+			m_integers.assign(m_size, 0);
+			break;
+		case column_type::NUMBER:
+			m_numbers.assign(m_size, 0);
+			break;
+		case column_type::BOOL:
+			m_bools.assign((m_size + 63) / 64, 0);
+			break;
+		case column_type::STRING:
+			m_string_offsets.assign(m_size + 1, 0);
+			break;
+		case column_type::NONE:
+			break;
+	}
+}
+
+void json_column::promote() {
+	m_numbers.assign(m_integers.cbegin(), m_integers.cend());
+	m_integers.clear();
+	m_integers.shrink_to_fit();
+	m_type = column_type::NUMBER;
+}
+
+void json_column::push_bit(bitmap_type& p_bits, const size_type p_pos, const bool p_bit) {
+	if (p_pos % 64 == 0) p_bits.push_back(0);
+	p_bits.back() |= static_cast<std::uint64_t>(p_bit) << (p_pos % 64);
+}
+
+
+// Public column_table member functions:
+
+column_table::column_table(const json_node& p_records) {
+	const auto& records = p_records.get_array();
+	for (const auto& record : records) append(record);
+}
+
+// The record's members and the columns are both sorted by key, so
+// they are merged in a single pass.
+
+void column_table::append(const json_node& p_record) {
+	const auto& obj = p_record.get_object();
+	auto member = obj.cbegin();
+	auto column = m_columns.begin();
+	while (member != obj.cend() || column != m_columns.end()) {
+		if (member == obj.cend() || (column != m_columns.end() && column->first < member->first)) {
+			column->second.append_null();
+			++column;
+		} else if (column == m_columns.end() || member->first < column->first) {
+			column = m_columns.emplace_hint(column, member->first, json_column());
+			for (size_type i = 0; i < m_size; ++i) column->second.append_null();
+			column->second.append(member->second);
+			++column;
+			++member;
+		} else {
+			column->second.append(member->second);
+			++column;
+			++member;
+		}
+	}
+	++m_size;
+}
+
+column_table::size_type column_table::size() const noexcept {
+	return m_size;
+}
+
+const json_column& column_table::get_column(const key_type& p_key) const {
+	return m_columns.at(p_key);
+}
+
+const column_table::columns_type& column_table::get_columns() const noexcept {
+	return m_columns;
+}
+
+
+// Column aggregation functions:
+
+// Null slots hold zero, so sums run over the whole buffer without
+// consulting the validity bitmap. Integers are summed exactly unless
+// the total would overflow, in which case the column is summed again in
+// floating point.
+
+json_column::number_type column_sum(const json_column& p_column) {
+	if (p_column.type() == json_column::column_type::NONE) return 0;
+	if (p_column.type() == json_column::column_type::INTEGER) {
+		const auto& values = p_column.get_integers();
+		json_column::integer_type sum = 0;
+		json_column::size_type i = 0;
+		while (i < values.size() && !__builtin_add_overflow(sum, values[i], &sum)) ++i;
+		if (i == values.size()) return static_cast<json_column::number_type>(sum);
+		json_column::number_type total = 0;
+		for (const auto value : values) total += value;
+		return total;
+	}
+	json_column::number_type sum = 0;
+	for (const auto value : p_column.get_numbers()) sum += value;
+	return sum;
+}
+
+json_column::number_type column_min(const json_column& p_column) {
+	const auto& validity = p_column.validity();
+	json_column::number_type result = std::numeric_limits<json_column::number_type>::infinity();
+	if (p_column.type() == json_column::column_type::NONE) return result;
+	if (p_column.type() == json_column::column_type::INTEGER) {
+		const auto& values = p_column.get_integers();
+		for (json_column::size_type i = 0; i < values.size(); ++i) {
+			const json_column::number_type value = (validity[i / 64] >> (i % 64)) & 1 ? values[i] : result;
+			result = value < result ? value : result;
+		}
+	} else {
+		const auto& values = p_column.get_numbers();
+		for (json_column::size_type i = 0; i < values.size(); ++i) {
+			const json_column::number_type value = (validity[i / 64] >> (i % 64)) & 1 ? values[i] : result;
+			result = value < result ? value : result;
+		}
+	}
+	return result;
+}
+
+json_column::number_type column_max(const json_column& p_column) {
+	const auto& validity = p_column.validity();
+	json_column::number_type result = -std::numeric_limits<json_column::number_type>::infinity();
+	if (p_column.type() == json_column::column_type::NONE) return result;
+	if (p_column.type() == json_column::column_type::INTEGER) {
+		const auto& values = p_column.get_integers();
+		for (json_column::size_type i = 0; i < values.size(); ++i) {
+			const json_column::number_type value = (validity[i / 64] >> (i % 64)) & 1 ? values[i] : result;
+			result = value > result ? value : result;
+		}
+	} else {
+		const auto& values = p_column.get_numbers();
+		for (json_column::size_type i = 0; i < values.size(); ++i) {
+			const json_column::number_type value = (validity[i / 64] >> (i % 64)) & 1 ? values[i] : result;
+			result = value > result ? value : result;
+		}
+	}
+	return result;
+}
+
+json_column::number_type column_mean(const json_column& p_column) {
+	const json_column::size_type count = column_count(p_column);
+	return count ? column_sum(p_column) / count : std::numeric_limits<json_column::number_type>::quiet_NaN();
+}
+
+json_column::size_type column_count(const json_column& p_column) noexcept {
+	json_column::size_type count = 0;
+	for (const auto word : p_column.validity()) count += __builtin_popcountll(word);
+	return count;
+}
+
+json_column::size_type column_count_true(const json_column& p_column) {
+	json_column::size_type count = 0;
+	for (const auto word : p_column.get_bools()) count += __builtin_popcountll(word);
+	return count;
+}
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "json_node.hh"
+#include "parsing.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace touchstone {
+
+// A single typed column of values in struct-of-arrays layout. Numbers
+// are kept as int64 while every value seen is integral and promoted to
+// double otherwise. Booleans and validity are packed into 64-bit words
+// and strings share one buffer indexed by offsets. Null slots hold a
+// zero (or an empty string) so that whole buffers can be scanned.
+
+class json_column {
+public:
+	using size_type = std::size_t;
+	using integer_type = std::int64_t;
+	using number_type = json_node::number_type;
+	using string_type = json_node::string_type;
+	using bitmap_type = std::vector<std::uint64_t>;
+
+	enum class column_type {
+		NONE,
+		INTEGER,
+		NUMBER,
+		BOOL,
+		STRING
+	};
+
+	json_column() = default;
+	void append(const json_node&);
+	void append_null();
+	void reserve(const size_type);
+	column_type type() const noexcept;
+	size_type size() const noexcept;
+	bool is_null(const size_type) const noexcept;
+	const bitmap_type& validity() const noexcept;
+	const std::vector<integer_type>& get_integers() const;
+	const std::vector<number_type>& get_numbers() const;
+	const bitmap_type& get_bools() const;
+	bool get_bool(const size_type) const;
+	const string_type& get_string_data() const;
+	const std::vector<size_type>& get_string_offsets() const;
+	string_type get_string(const size_type) const;
+
+private:
+	void set_type(const column_type);
+	void promote();
+	static void push_bit(bitmap_type&, const size_type, const bool);
+
+	column_type m_type{column_type::NONE};
+	size_type m_size{0};
+	bitmap_type m_validity;
+	std::vector<integer_type> m_integers;
+	std::vector<number_type> m_numbers;
+	bitmap_type m_bools;
+	string_type m_string_data;
+	std::vector<size_type> m_string_offsets{0};
+};
+
+// Columns extracted from an array of flat objects, one per key. Keys
+// missing from a record are null in that row.
+
+class column_table {
+public:
+	using size_type = std::size_t;
+	using key_type = json_node::object_type::key_type;
+	using columns_type = std::map<key_type, json_column>;
+
+	column_table() = default;
+	column_table(const json_node&);
+	void append(const json_node&);
+	size_type size() const noexcept;
+	const json_column& get_column(const key_type&) const;
+	const columns_type& get_columns() const noexcept;
+
+private:
+	columns_type m_columns;
+	size_type m_size{0};
+};
+
+template <typename InputIt>
+column_table parse_columns(InputIt, InputIt);
+
+// Aggregations over numeric and boolean columns, skipping nulls. A
+// column holding only nulls is empty: its sum is zero, its minimum and
+// maximum are +inf and -inf and its mean is NaN.
+
+json_column::number_type column_sum(const json_column&);
+json_column::number_type column_min(const json_column&);
+json_column::number_type column_max(const json_column&);
+json_column::number_type column_mean(const json_column&);
+json_column::size_type column_count(const json_column&) noexcept;
+json_column::size_type column_count_true(const json_column&);
+
+
+// Column parsing functions:
+
+// Each record is parsed into the same recycled node and appended to
+// the columns, so no document tree is built for the array.
+
+template <typename InputIt>
+column_table parse_columns(InputIt p_first, InputIt p_last) {
+	column_table table;
+	json_node record;
+	json_parser<InputIt>(p_first, p_last).parse_each(record, [&table](const json_node& p_record) {
+		table.append(p_record);
+	});
+	return table;
+}
+
+}
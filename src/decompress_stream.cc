@@ -0,0 +1,172 @@
+#include "decompress_stream.hh"
+
+#include <zlib.h>
+#ifdef TOUCHSTONE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <stdexcept>
+#include <vector>
+
+namespace touchstone {
+
+namespace {
+
+// Decodes gzip or zlib data, including concatenated gzip members.
+
+class gzip_decoder : public decompress_stream::decoder {
+public:
+	using size_type = decompress_stream::size_type;
+
+	gzip_decoder(file_descriptor&);
+	~gzip_decoder();
+	size_type decode(char*, const size_type) override;
+
+private:
+	file_descriptor& m_file;
+	size_type m_offset{0};
+	std::vector<char> m_input;
+	z_stream m_stream{};
+	bool m_finished{false};
+};
+
+gzip_decoder::gzip_decoder(file_descriptor& p_file) : m_file(p_file), m_input(decompress_stream::input_buffer_size) {
+	if (inflateInit2(&m_stream, 15 + 32) != Z_OK)
+		throw std::runtime_error{"Could not initialise zlib."};
+}
+
+gzip_decoder::~gzip_decoder() {
+	inflateEnd(&m_stream);
+}
+
+gzip_decoder::size_type gzip_decoder::decode(char* p_buf, const size_type p_size) {
+	m_stream.next_out = reinterpret_cast<Bytef*>(p_buf);
+	m_stream.avail_out = static_cast<uInt>(p_size);
+	while (m_stream.avail_out > 0 && !m_finished) {
+		if (m_stream.avail_in == 0) {
+			const size_type count = m_file.read(m_input.data(), m_input.size(), m_offset);
+			m_offset += count;
+			if (count == 0) throw std::runtime_error{"Truncated compressed stream."};
+			m_stream.next_in = reinterpret_cast<Bytef*>(m_input.data());
+			m_stream.avail_in = static_cast<uInt>(count);
+		}
+		const int result = inflate(&m_stream, Z_NO_FLUSH);
+		if (result == Z_STREAM_END) {
+			if (m_stream.avail_in == 0 && m_offset == m_file.size()) {
+				m_finished = true;
+			} else if (inflateReset(&m_stream) != Z_OK) {
+				throw std::runtime_error{"Could not reset zlib."};
+			}
+		} else if (result != Z_OK && result != Z_BUF_ERROR) {
+			throw std::runtime_error{m_stream.msg ? m_stream.msg : "Invalid compressed stream."};
+		}
+	}
+	return p_size - m_stream.avail_out;
+}
+
+#ifdef TOUCHSTONE_ZSTD
+
+// Decodes zstd data, including concatenated frames.
+
+class zstd_decoder : public decompress_stream::decoder {
+public:
+	using size_type = decompress_stream::size_type;
+
+	zstd_decoder(file_descriptor&);
+	~zstd_decoder();
+	size_type decode(char*, const size_type) override;
+
+private:
+	file_descriptor& m_file;
+	size_type m_offset{0};
+	std::vector<char> m_input;
+	ZSTD_inBuffer m_in{nullptr, 0, 0};
+	ZSTD_DStream* m_stream;
+	bool m_frame_complete{true};
+	bool m_input_finished{false};
+};
+
+zstd_decoder::zstd_decoder(file_descriptor& p_file) : m_file(p_file), m_input(decompress_stream::input_buffer_size), m_stream{ZSTD_createDStream()} {
+	if (!m_stream) throw std::runtime_error{"Could not initialise zstd."};
+	ZSTD_initDStream(m_stream);
+}
+
+zstd_decoder::~zstd_decoder() {
+	ZSTD_freeDStream(m_stream);
+}
+
+zstd_decoder::size_type zstd_decoder::decode(char* p_buf, const size_type p_size) {
+	ZSTD_outBuffer out{p_buf, p_size, 0};
+	while (out.pos < out.size) {
+		if (m_in.pos == m_in.size && !m_input_finished) {
+			const size_type count = m_file.read(m_input.data(), m_input.size(), m_offset);
+			m_offset += count;
+			if (count == 0) m_input_finished = true;
+			else m_in = ZSTD_inBuffer{m_input.data(), count, 0};
+		}
+		const size_type consumed = m_in.pos;
+		const size_type produced = out.pos;
+		const size_t result = ZSTD_decompressStream(m_stream, &out, &m_in);
+		if (ZSTD_isError(result)) throw std::runtime_error{ZSTD_getErrorName(result)};
+		// A call that makes no progress returns the next frame's size
+		// hint, which says nothing about whether the last frame ended.
+		if (m_in.pos != consumed || out.pos != produced) m_frame_complete = result == 0;
+		if (m_input_finished && m_in.pos == m_in.size && out.pos == produced) {
+			if (!m_frame_complete) throw std::runtime_error{"Truncated compressed stream."};
+			break;
+		}
+	}
+	return out.pos;
+}
+
+#endif
+
+}
+
+
+// Public decompress_stream static member variables:
+
+const decompress_stream::size_type decompress_stream::input_buffer_size{1 << 18};
+
+
+// Public decompress_stream member functions:
+
+decompress_stream::decompress_stream(const char* p_path, const size_type p_buffer_size, const size_type p_buffer_count) : m_file{p_path}, m_format{detect(m_file)}, m_decoder{make_decoder(m_format, m_file)}, m_pipeline{[this](char* p_buf, size_type p_size) { return m_decoder->decode(p_buf, p_size); }, p_buffer_size, p_buffer_count} {}
+
+decompress_stream::decompress_stream(const std::string& p_path, const size_type p_buffer_size, const size_type p_buffer_count) : decompress_stream{p_path.c_str(), p_buffer_size, p_buffer_count} {}
+
+decompress_stream::const_iterator decompress_stream::begin() {
+	return m_pipeline.begin();
+}
+
+decompress_stream::const_iterator decompress_stream::end() noexcept {
+	return m_pipeline.end();
+}
+
+decompress_stream::format decompress_stream::get_format() const noexcept {
+	return m_format;
+}
+
+
+// Private decompress_stream member functions:
+
+decompress_stream::format decompress_stream::detect(file_descriptor& p_file) {
+	unsigned char magic[4]{};
+	const size_type count = p_file.read(reinterpret_cast<char*>(magic), sizeof(magic), 0);
+	if (count == 4 && magic[0] == 0x28 && magic[1] == 0xB5 && magic[2] == 0x2F && magic[3] == 0xFD)
+		return format::ZSTD;
+	return format::GZIP;
+}
+
+std::unique_ptr<decompress_stream::decoder> decompress_stream::make_decoder(const format p_format, file_descriptor& p_file) {
+	if (p_format == format::ZSTD) {
+#ifdef TOUCHSTONE_ZSTD
+		return std::unique_ptr<decoder>(new zstd_decoder(p_file));
+#else
+		throw std::runtime_error{"Built without zstd support."};
+#endif
+	}
+	return std::unique_ptr<decoder>(new gzip_decoder(p_file));
+}
+
+}
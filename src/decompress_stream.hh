@@ -0,0 +1,55 @@
+#pragma once
+
+#include "read_ahead.hh"
+
+#include <memory>
+#include <string>
+
+namespace touchstone {
+
+// Streams a compressed file through a read_ahead pipeline, inflating
+// it a buffer at a time on the producer thread so that decompression
+// overlaps with parsing and the full document is never held. The
+// format is detected from the file's magic bytes. gzip and zlib are
+// always supported; zstd requires building with TOUCHSTONE_ZSTD
+// defined and linking against libzstd.
+
+class decompress_stream {
+public:
+	using size_type = read_ahead::size_type;
+	using const_iterator = read_ahead::const_iterator;
+
+	enum class format {
+		GZIP,
+		ZSTD
+	};
+
+	class decoder {
+	public:
+		virtual ~decoder() = default;
+		virtual size_type decode(char*, const size_type) = 0;
+	};
+
+	static const size_type input_buffer_size;
+
+	decompress_stream(const char*, const size_type = read_ahead::default_buffer_size, const size_type = read_ahead::default_buffer_count);
+	decompress_stream(const std::string&, const size_type = read_ahead::default_buffer_size, const size_type = read_ahead::default_buffer_count);
+	decompress_stream(const decompress_stream&) = delete;
+	decompress_stream& operator=(const decompress_stream&) = delete;
+	const_iterator begin();
+	const_iterator end() noexcept;
+	format get_format() const noexcept;
+
+private:
+	static format detect(file_descriptor&);
+	static std::unique_ptr<decoder> make_decoder(const format, file_descriptor&);
+
+	// Declared ahead of the pipeline so the decoder outlives the
+	// producer thread.
+	file_descriptor m_file;
+	format m_format;
+	std::unique_ptr<decoder> m_decoder;
+	read_ahead m_pipeline;
+};
+
+}
@@ -0,0 +1,199 @@
+#include "document_cache.hh"
+#include "parsing.hh"
+#include "read_ahead.hh"
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace touchstone {
+
+// Public document_cache static member variables:
+
+const document_cache::size_type document_cache::default_budget{64 << 20};
+const document_cache::size_type document_cache::default_shard_count{16};
+
+
+// Public document_cache member functions:
+
+document_cache& document_cache::global() {
+	static document_cache cache;
+	return cache;
+}
+
+document_cache::document_cache(const size_type p_budget, const size_type p_shards) : m_budget{p_budget} {
+	m_shards.resize(p_shards ? p_shards : 1);
+	for (auto& s : m_shards) s.reset(new shard());
+}
+
+document_cache::document_type document_cache::get(const std::string& p_path) {
+	struct stat file_info;
+	if (::stat(p_path.c_str(), &file_info) == -1) {
+		throw std::runtime_error{std::strerror(errno)};
+	}
+	identity id = identify(file_info);
+
+	shard& s = shard_for(p_path);
+	std::unique_lock<std::mutex> lock{s.mutex};
+	auto it = s.entries.find(p_path);
+	if (it != s.entries.end()) {
+		if (it->second.id == id) {
+			s.lru.splice(s.lru.begin(), s.lru, it->second.lru);
+			it->second.used = now();
+			std::shared_future<document_type> document = it->second.document;
+			lock.unlock();
+			return document.get();
+		}
+		discard(s, it);
+	}
+
+	std::promise<document_type> promise;
+	const std::uint64_t ticket = ++s.tickets;
+	entry& pending = s.entries[p_path];
+	pending.id = id;
+	pending.document = promise.get_future().share();
+	pending.lru = s.lru.insert(s.lru.begin(), p_path);
+	pending.ticket = ticket;
+	pending.used = now();
+	lock.unlock();
+
+	document_type document;
+	size_type bytes = 0;
+	try {
+		document = load(p_path, id);
+		bytes = document->memory_usage();
+	} catch (...) {
+		promise.set_exception(std::current_exception());
+		lock.lock();
+		it = s.entries.find(p_path);
+		if (it != s.entries.end() && it->second.ticket == ticket) discard(s, it);
+		throw;
+	}
+	promise.set_value(document);
+
+	lock.lock();
+	it = s.entries.find(p_path);
+	if (it == s.entries.end() || it->second.ticket != ticket) return document;
+	if (bytes > m_budget) {
+		discard(s, it);
+		return document;
+	}
+	it->second.id = id;
+	it->second.bytes = bytes;
+	it->second.ready = true;
+	m_bytes += bytes;
+	lock.unlock();
+	evict(p_path, ticket);
+	return document;
+}
+
+void document_cache::erase(const std::string& p_path) {
+	shard& s = shard_for(p_path);
+	std::lock_guard<std::mutex> lock{s.mutex};
+	auto it = s.entries.find(p_path);
+	if (it != s.entries.end()) discard(s, it);
+}
+
+void document_cache::clear() {
+	for (auto& s : m_shards) {
+		std::lock_guard<std::mutex> lock{s->mutex};
+		for (const auto& e : s->entries) m_bytes -= e.second.bytes;
+		s->entries.clear();
+		s->lru.clear();
+	}
+}
+
+document_cache::size_type document_cache::size() const {
+	return m_bytes;
+}
+
+document_cache::size_type document_cache::budget() const noexcept {
+	return m_budget;
+}
+
+
+// Private document_cache member functions:
+
+bool document_cache::identity::operator==(const identity& p_rhs) const noexcept {
+	return device == p_rhs.device && inode == p_rhs.inode && mtime_sec == p_rhs.mtime_sec && mtime_nsec == p_rhs.mtime_nsec && size == p_rhs.size;
+}
+
+document_cache::identity document_cache::identify(const struct stat& p_info) noexcept {
+	return identity{static_cast<std::uint64_t>(p_info.st_dev), static_cast<std::uint64_t>(p_info.st_ino), static_cast<std::int64_t>(p_info.st_mtim.tv_sec), p_info.st_mtim.tv_nsec, static_cast<std::int64_t>(p_info.st_size)};
+}
+
+// The identity is refreshed from the open descriptor so that the entry
+// describes the file that was actually read.
+
+std::uint64_t document_cache::now() noexcept {
+	return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+document_cache::document_type document_cache::load(const std::string& p_path, identity& p_id) {
+	file_descriptor file(p_path.c_str());
+	struct stat file_info;
+	if (fstat(file.get(), &file_info) == -1) {
+		throw std::runtime_error{std::strerror(errno)};
+	}
+	p_id = identify(file_info);
+	std::vector<char> contents(file_info.st_size);
+	contents.resize(file.read(contents.data(), contents.size(), 0));
+	return std::make_shared<const json_node>(parse(contents.cbegin(), contents.cend()));
+}
+
+document_cache::shard& document_cache::shard_for(const std::string& p_path) {
+	return *m_shards[std::hash<std::string>()(p_path) % m_shards.size()];
+}
+
+void document_cache::discard(shard& p_shard, std::unordered_map<std::string, entry>::iterator p_it) {
+	m_bytes -= p_it->second.bytes;
+	p_shard.lru.erase(p_it->second.lru);
+	p_shard.entries.erase(p_it);
+}
+
+// Returns the shard's least recently used document that may be
+// evicted, or the end of its entries. Documents still being parsed are
+// skipped since other threads may be waiting on them and they have no
+// size yet, as is the entry with the given path and ticket.
+
+std::unordered_map<std::string, document_cache::entry>::iterator document_cache::victim(shard& p_shard, const std::string& p_keep, const std::uint64_t p_ticket) {
+	for (auto it = p_shard.lru.rbegin(); it != p_shard.lru.rend(); ++it) {
+		auto found = p_shard.entries.find(*it);
+		if (found->second.ready && !(found->second.ticket == p_ticket && found->first == p_keep)) return found;
+	}
+	return p_shard.entries.end();
+}
+
+// Evicts the least recently used documents across all shards until the
+// total fits the budget, sparing the document just inserted. Shards are
+// locked one at a time, first to find the oldest candidate and then to
+// discard it, so the victim may have been used meanwhile; eviction is
+// approximately LRU under contention.
+
+void document_cache::evict(const std::string& p_keep, const std::uint64_t p_ticket) {
+	while (m_bytes > m_budget) {
+		shard* oldest = nullptr;
+		std::uint64_t oldest_used = std::numeric_limits<std::uint64_t>::max();
+		for (auto& s : m_shards) {
+			std::lock_guard<std::mutex> lock{s->mutex};
+			auto it = victim(*s, p_keep, p_ticket);
+			if (it != s->entries.end() && it->second.used < oldest_used) {
+				oldest = s.get();
+				oldest_used = it->second.used;
+			}
+		}
+		if (!oldest) return;
+		std::lock_guard<std::mutex> lock{oldest->mutex};
+		auto it = victim(*oldest, p_keep, p_ticket);
+		if (it != oldest->entries.end()) discard(*oldest, it);
+	}
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "json_node.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct stat;
+
+namespace touchstone {
+
+// Thread-safe cache of parsed files, shared as immutable documents.
+// An entry is valid while the file's device, inode, modification time
+// and size are unchanged. Concurrent requests for a file being parsed
+// wait on the same parse rather than starting their own. Entries are
+// spread over independently locked shards by path. Their sizes are
+// totalled across shards, and once the total exceeds the byte budget
+// the least recently used documents of any shard are evicted, never
+// the one just loaded. A document larger than the whole budget is
+// returned to its callers but not kept. Entries are stamped with the
+// steady clock on use, so hits write only to their own shard.
+
+class document_cache {
+public:
+	using size_type = std::size_t;
+	using document_type = std::shared_ptr<const json_node>;
+
+	static const size_type default_budget;
+	static const size_type default_shard_count;
+
+	static document_cache& global();
+	document_cache(const size_type = default_budget, const size_type = default_shard_count);
+	document_cache(const document_cache&) = delete;
+	document_cache& operator=(const document_cache&) = delete;
+	document_type get(const std::string&);
+	void erase(const std::string&);
+	void clear();
+	size_type size() const;
+	size_type budget() const noexcept;
+
+private:
+	struct identity {
+		std::uint64_t device;
+		std::uint64_t inode;
+		std::int64_t mtime_sec;
+		long mtime_nsec;
+		std::int64_t size;
+
+		bool operator==(const identity&) const noexcept;
+	};
+
+	struct entry {
+		identity id;
+		std::shared_future<document_type> document;
+		std::list<std::string>::iterator lru;
+		std::uint64_t ticket;
+		std::uint64_t used{0};
+		size_type bytes{0};
+		bool ready{false};
+	};
+
+	struct shard {
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, entry> entries;
+		std::list<std::string> lru;
+		std::uint64_t tickets{0};
+	};
+
+	static identity identify(const struct stat&) noexcept;
+	static std::uint64_t now() noexcept;
+	static document_type load(const std::string&, identity&);
+	shard& shard_for(const std::string&);
+	void discard(shard&, std::unordered_map<std::string, entry>::iterator);
+	std::unordered_map<std::string, entry>::iterator victim(shard&, const std::string&, const std::uint64_t);
+	void evict(const std::string&, const std::uint64_t);
+
+	size_type m_budget;
+	std::atomic<size_type> m_bytes{0};
+	std::vector<std::unique_ptr<shard>> m_shards;
+};
+
+}
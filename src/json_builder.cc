@@ -0,0 +1,86 @@
+#include "json_builder.hh"
+
+namespace touchstone {
+
+// Open containers below the root live in heap storage that moves along
+// with the root, so only the root's own entry on the stack changes.
+
+json_builder::json_builder(json_builder&& p_builder) noexcept : m_root{std::move(p_builder.m_root)}, m_stack{std::move(p_builder.m_stack)}, m_key{std::move(p_builder.m_key)}, m_has_key{p_builder.m_has_key}, m_complete{p_builder.m_complete} {
+	if (!m_stack.empty()) m_stack.front() = &m_root;
+	p_builder.m_stack.clear();
+	p_builder.m_has_key = false;
+	p_builder.m_complete = false;
+}
+
+json_builder& json_builder::operator=(json_builder&& p_builder) noexcept {
+	if (this == &p_builder) return *this;
+	m_root = std::move(p_builder.m_root);
+	m_stack = std::move(p_builder.m_stack);
+	m_key = std::move(p_builder.m_key);
+	m_has_key = p_builder.m_has_key;
+	m_complete = p_builder.m_complete;
+	if (!m_stack.empty()) m_stack.front() = &m_root;
+	p_builder.m_stack.clear();
+	p_builder.m_has_key = false;
+	p_builder.m_complete = false;
+	return *this;
+}
+
+json_builder& json_builder::begin_object() {
+	json_node& node = place(json_node::object_type());
+	m_complete = false;
+	m_stack.push_back(&node);
+	return *this;
+}
+
+json_builder& json_builder::end_object() {
+	if (m_stack.empty() || !m_stack.back()->is_object() || m_has_key)
+		throw std::runtime_error{"Invalid operation."};
+	m_stack.pop_back();
+	m_complete = m_stack.empty();
+	return *this;
+}
+
+json_builder& json_builder::begin_array(const size_type p_size) {
+	json_node& node = place(json_node::array_type());
+	m_complete = false;
+	node.reserve(p_size);
+	m_stack.push_back(&node);
+	return *this;
+}
+
+json_builder& json_builder::end_array() {
+	if (m_stack.empty() || !m_stack.back()->is_array())
+		throw std::runtime_error{"Invalid operation."};
+	m_stack.pop_back();
+	m_complete = m_stack.empty();
+	return *this;
+}
+
+json_builder& json_builder::key(const key_type& p_key) {
+	if (m_stack.empty() || !m_stack.back()->is_object() || m_has_key)
+		throw std::runtime_error{"Invalid operation."};
+	m_key = p_key;
+	m_has_key = true;
+	return *this;
+}
+
+json_builder& json_builder::key(const char* const p_key) {
+	if (m_stack.empty() || !m_stack.back()->is_object() || m_has_key)
+		throw std::runtime_error{"Invalid operation."};
+	m_key = p_key;
+	m_has_key = true;
+	return *this;
+}
+
+bool json_builder::complete() const noexcept {
+	return m_complete;
+}
+
+json_node json_builder::release() {
+	if (!m_complete) throw std::runtime_error{"Invalid operation."};
+	m_complete = false;
+	return std::move(m_root);
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "json_node.hh"
+
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace touchstone {
+
+// Streams a document into a json_node, constructing every value
+// directly inside its parent container. A builder may be moved part
+// way through a document, the open containers moving with it.
+
+class json_builder {
+public:
+	using key_type = json_node::object_type::key_type;
+	using size_type = json_node::array_type::size_type;
+
+	json_builder() = default;
+	json_builder(const json_builder&) = delete;
+	json_builder(json_builder&&) noexcept;
+	json_builder& operator=(const json_builder&) = delete;
+	json_builder& operator=(json_builder&&) noexcept;
+	json_builder& begin_object();
+	json_builder& end_object();
+	json_builder& begin_array(const size_type = 0);
+	json_builder& end_array();
+	json_builder& key(const key_type&);
+	json_builder& key(const char* const);
+	template <typename... Args>
+	json_builder& value(Args&&...);
+	bool complete() const noexcept;
+	json_node release();
+
+private:
+	template <typename... Args>
+	json_node& place(Args&&...);
+
+	json_node m_root;
+	std::vector<json_node*> m_stack;
+	key_type m_key;
+	bool m_has_key{false};
+	bool m_complete{false};
+};
+
+
+// Public json_builder member function templates:
+
+template <typename... Args>
+json_builder& json_builder::value(Args&&... p_args) {
+	place(std::forward<Args>(p_args)...);
+	return *this;
+}
+
+
+// Private json_builder member function templates:
+
+template <typename... Args>
+json_node& json_builder::place(Args&&... p_args) {
+	if (m_stack.empty()) {
+		if (m_complete) throw std::runtime_error{"Invalid operation."};
+		m_root = json_node(std::forward<Args>(p_args)...);
+		m_complete = true;
+		return m_root;
+	}
+	json_node& parent = *m_stack.back();
+	if (parent.is_array()) {
+		return parent.emplace_back(std::forward<Args>(p_args)...);
+	}
+	if (!m_has_key) throw std::runtime_error{"Invalid operation."};
+	m_has_key = false;
+	auto& obj = parent.get_object();
+	auto it = obj.lower_bound(m_key);
+	if (it != obj.end() && it->first == m_key) {
+		it->second = json_node(std::forward<Args>(p_args)...);
+		return it->second;
+	}
+	return obj.emplace_hint(it, std::piecewise_construct, std::forward_as_tuple(m_key), std::forward_as_tuple(std::forward<Args>(p_args)...))->second;
+}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace touchstone {
+
+// Formatting of scalars shared by operator<< and json_serializer so
+// that both produce the same, parseable text.
+
+namespace format {
+
+const std::size_t max_number_length{32};
+
+// Writes the shortest of %.15g, %.16g and %.17g that reads back as the
+// same double, so numbers survive a round trip. Integers below 1e15
+// skip printf. JSON has no infinities or NaN, so those are written as
+// null.
+
+inline std::size_t number(const double p_number, char* p_out) {
+	if (!std::isfinite(p_number)) {
+		std::memcpy(p_out, "null", 4);
+		return 4;
+	}
+	if (p_number > -1e15 && p_number < 1e15 && p_number == static_cast<long long>(p_number) && !(p_number == 0 && std::signbit(p_number))) {
+		long long value = static_cast<long long>(p_number);
+		std::size_t size = 0;
+		if (value < 0) {
+			p_out[size++] = '-';
+			value = -value;
+		}
+		char digits[16];
+		std::size_t count = 0;
+		do {
+			digits[count++] = '0' + value % 10;
+			value /= 10;
+		} while (value);
+		while (count) p_out[size++] = digits[--count];
+		return size;
+	}
+	int size = 0;
+	for (int precision = 15; precision <= 17; ++precision) {
+		size = std::snprintf(p_out, max_number_length, "%.*g", precision, p_number);
+		if (std::strtod(p_out, nullptr) == p_number) break;
+	}
+	return size;
+}
+
+inline bool needs_escape(const char p_char) noexcept {
+	return p_char == '\"' || p_char == '\\' || static_cast<unsigned char>(p_char) < 0x20;
+}
+
+// Writes the escape sequence for a character that needs one, returning
+// the end of the output. Control characters without a short form use
+// \u00XX.
+
+inline char* escape(const char p_char, char* p_out) noexcept {
+	char letter = 0;
+	switch (p_char) {
+		case '\"': letter = '\"'; break;
+		case '\\': letter = '\\'; break;
+		case '\b': letter = 'b'; break;
+		case '\f': letter = 'f'; break;
+		case '\n': letter = 'n'; break;
+		case '\r': letter = 'r'; break;
+		case '\t': letter = 't'; break;
+	}
+	*p_out++ = '\\';
+	if (letter) {
+		*p_out++ = letter;
+		return p_out;
+	}
+	static const char hex[] = "0123456789abcdef";
+	std::memcpy(p_out, "u00", 3);
+	p_out[3] = hex[(p_char >> 4) & 0xF];
+	p_out[4] = hex[p_char & 0xF];
+	return p_out + 5;
+}
+
+// Size of the string once escaped, quotes included.
+
+inline std::size_t quoted_size(const std::string& p_str) noexcept {
+	char sequence[6];
+	std::size_t size = p_str.size() + 2;
+	for (const char c : p_str) {
+		if (needs_escape(c)) size += escape(c, sequence) - sequence - 1;
+	}
+	return size;
+}
+
+// Writes the string escaped and in quotes, returning the end of the
+// output. Bytes outside ASCII are copied as they are.
+
+inline char* quote(const std::string& p_str, char* p_out) {
+	*p_out++ = '\"';
+	const char* run = p_str.data();
+	const char* end = run + p_str.size();
+	for (const char* c = run; c != end; ++c) {
+		if (!needs_escape(*c)) continue;
+		std::memcpy(p_out, run, c - run);
+		p_out = escape(*c, p_out + (c - run));
+		run = c + 1;
+	}
+	std::memcpy(p_out, run, end - run);
+	p_out += end - run;
+	*p_out++ = '\"';
+	return p_out;
+}
+
+// Stream forms of the above for operator<<.
+
+inline std::ostream& number(std::ostream& p_os, const double p_number) {
+	char buffer[max_number_length];
+	return p_os.write(buffer, number(p_number, buffer));
+}
+
+inline std::ostream& quote(std::ostream& p_os, const std::string& p_str) {
+	p_os.put('\"');
+	const char* run = p_str.data();
+	const char* end = run + p_str.size();
+	for (const char* c = run; c != end; ++c) {
+		if (!needs_escape(*c)) continue;
+		char sequence[6];
+		p_os.write(run, c - run).write(sequence, escape(*c, sequence) - sequence);
+		run = c + 1;
+	}
+	return p_os.write(run, end - run).put('\"');
+}
+
+}
+
+}
@@ -0,0 +1,65 @@
+#include "json_interner.hh"
+
+#include <utility>
+
+namespace touchstone {
+
+// Public json_interner member functions:
+
+json_interner::node_type json_interner::intern(const json_node& p_node) {
+	const std::size_t hash = p_node.hash();
+	node_type node = find(p_node, hash);
+	if (!node) {
+		node = std::make_shared<const json_node>(p_node);
+		m_nodes.emplace(hash, node);
+	}
+	return node;
+}
+
+json_interner::node_type json_interner::intern(json_node&& p_node) {
+	const std::size_t hash = p_node.hash();
+	node_type node = find(p_node, hash);
+	if (!node) {
+		node = std::make_shared<const json_node>(std::move(p_node));
+		m_nodes.emplace(hash, node);
+	}
+	return node;
+}
+
+// Drops the nodes nobody outside the interner refers to any more and
+// returns how many were dropped.
+
+json_interner::size_type json_interner::purge() {
+	size_type count = 0;
+	auto it = m_nodes.begin();
+	while (it != m_nodes.end()) {
+		if (it->second.use_count() == 1) {
+			it = m_nodes.erase(it);
+			++count;
+		} else {
+			++it;
+		}
+	}
+	return count;
+}
+
+void json_interner::clear() noexcept {
+	m_nodes.clear();
+}
+
+json_interner::size_type json_interner::size() const noexcept {
+	return m_nodes.size();
+}
+
+
+// Private json_interner member functions:
+
+json_interner::node_type json_interner::find(const json_node& p_node, const std::size_t p_hash) const {
+	auto range = m_nodes.equal_range(p_hash);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (*it->second == p_node) return it->second;
+	}
+	return nullptr;
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "json_node.hh"
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+namespace touchstone {
+
+// Hash-consing table for documents and subtrees. Interning a node
+// returns a shared, immutable copy that is stored once no matter how
+// many structurally equal nodes are interned, so repetitive records
+// cost one copy each plus a pointer per occurrence.
+
+class json_interner {
+public:
+	using size_type = std::size_t;
+	using node_type = std::shared_ptr<const json_node>;
+
+	json_interner() = default;
+	json_interner(const json_interner&) = delete;
+	json_interner& operator=(const json_interner&) = delete;
+	node_type intern(const json_node&);
+	node_type intern(json_node&&);
+	size_type purge();
+	void clear() noexcept;
+	size_type size() const noexcept;
+
+private:
+	node_type find(const json_node&, const std::size_t) const;
+
+	std::unordered_multimap<std::size_t, node_type> m_nodes;
+};
+
+}
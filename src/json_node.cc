@@ -1,5 +1,7 @@
 #include "json_node.hh"
 
+#include "json_format.hh"
+
 #include <cstring>
 #include <sstream>
 #include <stdexcept>
@@ -12,13 +14,18 @@ std::string to_string(const json_node::string_type&);
 std::string to_string(const json_node::number_type&);
 std::string to_string(const json_node::bool_type&);
 
+
+// Public json_node static member variables:
+
+const std::size_t json_node::member_overhead{4 * sizeof(void*)};
+
 json_node::json_node(const json_node& p_node) : m_type{p_node.m_type} {
 	switch(m_type) {
 		case json_type::OBJECT:
 			new (&m_value.obj) object_type{p_node.m_value.obj};
 			break;
 		case json_type::ARRAY:
-			new (&m_value.arr) array_type{p_node.m_value.arr};
+			new (&m_value.arr) array_type(p_node.m_value.arr);
 			break;
 		case json_type::STRING:
 			new (&m_value.str) string_type{p_node.m_value.str};
@@ -28,10 +35,16 @@ json_node::json_node(const json_node& p_node) : m_type{p_node.m_type} {
 			break;
 		case json_type::BOOL:
 			m_value.boo = p_node.m_value.boo;
+			break;
+		case json_type::NUMBER_ARRAY:
+			new (&m_value.nums) packed_number_type(p_node.m_value.nums);
+			break;
+		case json_type::BOOL_ARRAY:
+			new (&m_value.bits) packed_bool_type(p_node.m_value.bits);
 	}
 }
 
-json_node::json_node(json_node&& p_node) : m_type{p_node.m_type} {
+json_node::json_node(json_node&& p_node) noexcept : m_type{p_node.m_type} {
 	switch(m_type) {
 		case json_type::OBJECT:
 			new (&m_value.obj) object_type(std::move(p_node.m_value.obj));
@@ -47,24 +60,30 @@ json_node::json_node(json_node&& p_node) : m_type{p_node.m_type} {
 			break;
 		case json_type::BOOL:
 			m_value.boo = p_node.m_value.boo;
+			break;
+		case json_type::NUMBER_ARRAY:
+			new (&m_value.nums) packed_number_type(std::move(p_node.m_value.nums));
+			break;
+		case json_type::BOOL_ARRAY:
+			new (&m_value.bits) packed_bool_type(std::move(p_node.m_value.bits));
 	}
 }
 
 json_node::json_node(const object_type& p_obj) : m_type{json_type::OBJECT}, m_value{p_obj} {}
 
-json_node::json_node(object_type&& p_obj) : m_type{json_type::OBJECT} {
+json_node::json_node(object_type&& p_obj) noexcept : m_type{json_type::OBJECT} {
 	new (&m_value.obj) object_type(std::move(p_obj));
 }
 
 json_node::json_node(const array_type& p_arr) : m_type{json_type::ARRAY}, m_value{p_arr} {}
 
-json_node::json_node(array_type&& p_arr) : m_type{json_type::ARRAY} {
+json_node::json_node(array_type&& p_arr) noexcept : m_type{json_type::ARRAY} {
 	new (&m_value.arr) array_type(std::move(p_arr));
 }
 
 json_node::json_node(const string_type& p_str) : m_type{json_type::STRING}, m_value{p_str} {}
 
-json_node::json_node(string_type&& p_str) : m_type{json_type::STRING} {
+json_node::json_node(string_type&& p_str) noexcept : m_type{json_type::STRING} {
 	new (&m_value.str) string_type(std::move(p_str));
 }
 
@@ -74,10 +93,24 @@ json_node::json_node(const number_type p_num) : m_type{json_type::NUMBER}, m_val
 
 json_node::json_node(const bool_type boo) : m_type{json_type::BOOL}, m_value{boo} {}
 
+json_node::json_node(const packed_number_type& p_nums) : m_type{json_type::NUMBER_ARRAY} {
+	new (&m_value.nums) packed_number_type(p_nums);
+}
+
+json_node::json_node(packed_number_type&& p_nums) noexcept : m_type{json_type::NUMBER_ARRAY} {
+	new (&m_value.nums) packed_number_type(std::move(p_nums));
+}
+
+json_node::json_node(const packed_bool_type& p_bits) : m_type{json_type::BOOL_ARRAY} {
+	new (&m_value.bits) packed_bool_type(p_bits);
+}
+
+json_node::json_node(packed_bool_type&& p_bits) noexcept : m_type{json_type::BOOL_ARRAY} {
+	new (&m_value.bits) packed_bool_type(std::move(p_bits));
+}
+
 json_node::~json_node() {
-	if (m_type == json_type::OBJECT) m_value.obj.~object_type();
-	else if (m_type == json_type::ARRAY) m_value.arr.~array_type();
-	else if (m_type == json_type::STRING) m_value.str.~string_type();
+	destroy();
 }
 
 json_node& json_node::operator=(const json_node& p_node) {
@@ -92,13 +125,31 @@ json_node& json_node::operator=(const json_node& p_node) {
 			return *this = p_node.m_value.num;
 		case json_type::BOOL:
 			return *this = p_node.m_value.boo;
+		case json_type::NUMBER_ARRAY:
+			if (m_type == json_type::NUMBER_ARRAY) {
+				m_value.nums = p_node.m_value.nums;
+			} else {
+				nullify();
+				new (&m_value.nums) packed_number_type(p_node.m_value.nums);
+				m_type = json_type::NUMBER_ARRAY;
+			}
+			return *this;
+		case json_type::BOOL_ARRAY:
+			if (m_type == json_type::BOOL_ARRAY) {
+				m_value.bits = p_node.m_value.bits;
+			} else {
+				nullify();
+				new (&m_value.bits) packed_bool_type(p_node.m_value.bits);
+				m_type = json_type::BOOL_ARRAY;
+			}
+			return *this;
 	}
-	m_type = json_type::NONE;
+	nullify();
 	return *this;
 }
 
-json_node& json_node::operator=(json_node&& p_node) {
-		switch(p_node.m_type) {
+json_node& json_node::operator=(json_node&& p_node) noexcept {
+	switch(p_node.m_type) {
 		case json_type::OBJECT:
 			return *this = std::move(p_node.m_value.obj);
 		case json_type::ARRAY:
@@ -109,8 +160,22 @@ json_node& json_node::operator=(json_node&& p_node) {
 			return *this = p_node.m_value.num;
 		case json_type::BOOL:
 			return *this = p_node.m_value.boo;
+		case json_type::NUMBER_ARRAY:
+			if (this != &p_node) {
+				nullify();
+				new (&m_value.nums) packed_number_type(std::move(p_node.m_value.nums));
+				m_type = json_type::NUMBER_ARRAY;
+			}
+			return *this;
+		case json_type::BOOL_ARRAY:
+			if (this != &p_node) {
+				nullify();
+				new (&m_value.bits) packed_bool_type(std::move(p_node.m_value.bits));
+				m_type = json_type::BOOL_ARRAY;
+			}
+			return *this;
 	}
-	m_type = json_type::NONE;
+	nullify();
 	return *this;
 }
 
@@ -118,25 +183,19 @@ json_node& json_node::operator=(const object_type& p_obj) {
 	if (m_type == json_type::OBJECT) {
 		m_value.obj = p_obj;
 		return *this;
-	} else if (m_type == json_type::ARRAY) {
-		m_value.arr.~array_type();
-	} else if(m_type == json_type::STRING) {
-		m_value.str.~string_type();
 	}
+	destroy();
 	m_type = json_type::OBJECT;
 	new (&m_value.obj) object_type{p_obj};
 	return *this;
 }
 
-json_node& json_node::operator=(object_type&& p_obj) {
+json_node& json_node::operator=(object_type&& p_obj) noexcept {
 	if (m_type == json_type::OBJECT) {
 		m_value.obj = std::move(p_obj);
 		return *this;
-	} else if (m_type == json_type::ARRAY) {
-		m_value.arr.~array_type();
-	} else if(m_type == json_type::STRING) {
-		m_value.str.~string_type();
 	}
+	destroy();
 	m_type = json_type::OBJECT;
 	new (&m_value.obj) object_type(std::move(p_obj));
 	return *this;
@@ -146,25 +205,19 @@ json_node& json_node::operator=(const array_type& p_arr) {
 	if (m_type == json_type::ARRAY) {
 		m_value.arr = p_arr;
 		return *this;
-	} else if (m_type == json_type::OBJECT) {
-		m_value.obj.~object_type();
-	} else if (m_type == json_type::STRING) {
-		m_value.str.~string_type();
 	}
+	destroy();
 	m_type = json_type::ARRAY;
-	new (&m_value.arr) array_type{p_arr};
+	new (&m_value.arr) array_type(p_arr);
 	return *this;
 }
 
-json_node& json_node::operator=(array_type&& p_arr) {
+json_node& json_node::operator=(array_type&& p_arr) noexcept {
 	if (m_type == json_type::ARRAY) {
 		m_value.arr = std::move(p_arr);
 		return *this;
-	} else if (m_type == json_type::OBJECT) {
-		m_value.obj.~object_type();
-	} else if (m_type == json_type::STRING) {
-		m_value.str.~string_type();
 	}
+	destroy();
 	m_type = json_type::ARRAY;
 	new (&m_value.arr) array_type(std::move(p_arr));
 	return *this;
@@ -174,25 +227,19 @@ json_node& json_node::operator=(const string_type& p_str) {
 	if (m_type == json_type::STRING) {
 		m_value.str = p_str;
 		return *this;
-	} else if (m_type == json_type::OBJECT) {
-		m_value.obj.~object_type();
-	} else if (m_type == json_type::ARRAY) {
-		m_value.arr.~array_type();
 	}
+	destroy();
 	m_type = json_type::STRING;
 	new (&m_value.str) string_type{p_str};
 	return *this;
 }
 
-json_node& json_node::operator=(string_type&& p_str) {
+json_node& json_node::operator=(string_type&& p_str) noexcept {
 	if (m_type == json_type::STRING) {
 		m_value.str = std::move(p_str);
 		return *this;
-	} else if (m_type == json_type::OBJECT) {
-		m_value.obj.~object_type();
-	} else if (m_type == json_type::ARRAY) {
-		m_value.arr.~array_type();
 	}
+	destroy();
 	m_type = json_type::STRING;
 	new (&m_value.str) string_type(std::move(p_str));
 	return *this;
@@ -200,18 +247,14 @@ json_node& json_node::operator=(string_type&& p_str) {
 
 
 json_node& json_node::operator=(const number_type& p_num) {
-	if (m_type == json_type::OBJECT) m_value.obj.~object_type();
-	else if (m_type == json_type::ARRAY) m_value.arr.~array_type();
-	else if (m_type == json_type::STRING) m_value.str.~string_type();
+	destroy();
 	m_type = json_type::NUMBER;
 	m_value.num = p_num;
 	return *this;
 }
 
 json_node& json_node::operator=(const bool_type& p_boo) {
-	if (m_type == json_type::OBJECT) m_value.obj.~object_type();
-	else if (m_type == json_type::ARRAY) m_value.arr.~array_type();
-	else if (m_type == json_type::STRING) m_value.str.~string_type();
+	destroy();
 	m_type = json_type::BOOL;
 	m_value.boo = p_boo;
 	return *this;
@@ -224,7 +267,7 @@ std::ostream& operator<<(std::ostream& os, const json_node& p_node) {
 			os << '{';
 			auto it = p_node.m_value.obj.cbegin();
 			while (it != p_node.m_value.obj.cend()) {
-				os << '\"' << it->first << "\":" << it->second;
+				format::quote(os, it->first) << ':' << it->second;
 				if (++it != p_node.m_value.obj.cend()) os << ',';
 			}
 			return os << '}';
@@ -239,14 +282,33 @@ std::ostream& operator<<(std::ostream& os, const json_node& p_node) {
 			return os << ']';
 		}
 		case json_type::STRING:
-			return os << '\"' << p_node.m_value.str << '\"';
+			return format::quote(os, p_node.m_value.str);
 		case json_type::NUMBER:
-			return os << p_node.m_value.num;
+			return format::number(os, p_node.m_value.num);
 		case json_type::BOOL:
 			return os << (p_node.m_value.boo ? "true" : "false");
 		case json_type::NONE:
 			return os << "null";
+		case json_type::NUMBER_ARRAY: {
+			auto it = p_node.m_value.nums.cbegin();
+			os << '[';
+			while (it != p_node.m_value.nums.cend()) {
+				format::number(os, *it);
+				if (++it != p_node.m_value.nums.cend()) os << ',';
+			}
+			return os << ']';
+		}
+		case json_type::BOOL_ARRAY: {
+			auto it = p_node.m_value.bits.cbegin();
+			os << '[';
+			while (it != p_node.m_value.bits.cend()) {
+				os << (*it ? "true" : "false");
+				if (++it != p_node.m_value.bits.cend()) os << ',';
+			}
+			return os << ']';
+		}
 	}
+	return os;
 }
 
 bool json_node::is_object() const noexcept {
@@ -254,7 +316,7 @@ bool json_node::is_object() const noexcept {
 }
 
 bool json_node::is_array() const noexcept {
-	return m_type == json_type::ARRAY;
+	return m_type == json_type::ARRAY || is_packed();
 }
 
 bool json_node::is_string() const noexcept {
@@ -273,16 +335,60 @@ bool json_node::is_null() const noexcept {
 	return m_type == json_type::NONE;
 }
 
-void json_node::nullify() noexcept [[noreturn]] {
+bool json_node::is_packed() const noexcept {
+	return m_type == json_type::NUMBER_ARRAY || m_type == json_type::BOOL_ARRAY;
+}
+
+bool json_node::is_number_array() const noexcept {
+	return m_type == json_type::NUMBER_ARRAY;
+}
+
+bool json_node::is_bool_array() const noexcept {
+	return m_type == json_type::BOOL_ARRAY;
+}
+
+void json_node::nullify() noexcept {
+	destroy();
 	m_type = json_type::NONE;
 }
 
+void json_node::swap(json_node& p_node) noexcept {
+	if (this == &p_node) return;
+	json_node temp{std::move(p_node)};
+	p_node = std::move(*this);
+	*this = std::move(temp);
+}
+
+void json_node::reserve(const array_type::size_type p_size) {
+	if (is_packed()) {
+		unpack();
+	} else if (m_type == json_type::NONE) {
+		new (&m_value.arr) array_type();
+		m_type = json_type::ARRAY;
+	} else if (m_type != json_type::ARRAY) {
+		throw std::runtime_error{"Invalid operation."};
+	}
+	m_value.arr.reserve(p_size);
+}
+
 json_node::object_type& json_node::get_object() {
 	if (m_type == json_type::OBJECT) return m_value.obj;
 	throw std::runtime_error{"Invalid type."};
 }
 
+const json_node::object_type& json_node::get_object() const {
+	if (m_type == json_type::OBJECT) return m_value.obj;
+	throw std::runtime_error{"Invalid type."};
+}
+
 json_node::array_type& json_node::get_array() {
+	unpack();
+	if (m_type == json_type::ARRAY) return m_value.arr;
+	throw std::runtime_error{"Invalid type."};
+}
+
+const json_node::array_type& json_node::get_array() const {
+	if (is_packed()) throw std::runtime_error{"Invalid operation."};
 	if (m_type == json_type::ARRAY) return m_value.arr;
 	throw std::runtime_error{"Invalid type."};
 }
@@ -292,28 +398,297 @@ json_node::string_type& json_node::get_string() {
 	throw std::runtime_error{"Invalid type."};
 }
 
+const json_node::string_type& json_node::get_string() const {
+	if (m_type == json_type::STRING) return m_value.str;
+	throw std::runtime_error{"Invalid type."};
+}
+
 json_node::number_type& json_node::get_number() {
 	if (m_type == json_type::NUMBER) return m_value.num;
 	throw std::runtime_error{"Invalid type."};
 }
 
+const json_node::number_type& json_node::get_number() const {
+	if (m_type == json_type::NUMBER) return m_value.num;
+	throw std::runtime_error{"Invalid type."};
+}
+
 json_node::bool_type& json_node::get_bool() {
 	if (m_type == json_type::BOOL) return m_value.boo;
 	throw std::runtime_error{"Invalid type."};
 }
 
+const json_node::bool_type& json_node::get_bool() const {
+	if (m_type == json_type::BOOL) return m_value.boo;
+	throw std::runtime_error{"Invalid type."};
+}
+
 json_node& json_node::get_node(const object_type::key_type& p_key) {
 	if (m_type == json_type::OBJECT) return m_value.obj.at(p_key);
 	throw std::runtime_error{"Invalid operation."};
 }
 
+const json_node& json_node::get_node(const object_type::key_type& p_key) const {
+	if (m_type == json_type::OBJECT) return m_value.obj.at(p_key);
+	throw std::runtime_error{"Invalid operation."};
+}
+
 json_node& json_node::get_node(const array_type::size_type& p_pos) {
+	unpack();
 	if (m_type == json_type::ARRAY) return m_value.arr.at(p_pos);
 	throw std::runtime_error{"Invalid operation."};
 }
 
+// Packed arrays hold no nodes to refer to, so the const node accessors
+// reject them; get_number(pos) and get_bool(pos) read their elements.
+
+const json_node& json_node::get_node(const array_type::size_type& p_pos) const {
+	if (is_packed()) throw std::runtime_error{"Invalid operation."};
+	if (m_type == json_type::ARRAY) return m_value.arr.at(p_pos);
+	throw std::runtime_error{"Invalid operation."};
+}
+
+// Read elements of any array representation by value, so that packed
+// arrays can be read without unpacking them, including through const
+// references where get_node() cannot hand out a node. element() and
+// elements() do the same for every element type.
+
+json_node::number_type json_node::get_number(const array_type::size_type& p_pos) const {
+	if (m_type == json_type::NUMBER_ARRAY) return m_value.nums.at(p_pos);
+	if (m_type == json_type::ARRAY) return m_value.arr.at(p_pos).get_number();
+	throw std::runtime_error{"Invalid operation."};
+}
+
+json_node::bool_type json_node::get_bool(const array_type::size_type& p_pos) const {
+	if (m_type == json_type::BOOL_ARRAY) return m_value.bits.at(p_pos) != 0;
+	if (m_type == json_type::ARRAY) return m_value.arr.at(p_pos).get_bool();
+	throw std::runtime_error{"Invalid operation."};
+}
+
+json_node::const_element json_node::element(const array_type::size_type& p_pos) const {
+	if (p_pos >= array_size()) throw std::out_of_range{"Invalid index."};
+	return const_element(*this, p_pos);
+}
+
+json_node::const_element_range json_node::elements() const {
+	return const_element_range(*this);
+}
+
+json_node::array_type::size_type json_node::array_size() const {
+	if (m_type == json_type::ARRAY) return m_value.arr.size();
+	if (m_type == json_type::NUMBER_ARRAY) return m_value.nums.size();
+	if (m_type == json_type::BOOL_ARRAY) return m_value.bits.size();
+	throw std::runtime_error{"Invalid type."};
+}
+
+json_node::packed_number_type& json_node::get_packed_numbers() {
+	if (m_type == json_type::NUMBER_ARRAY) return m_value.nums;
+	throw std::runtime_error{"Invalid type."};
+}
+
+const json_node::packed_number_type& json_node::get_packed_numbers() const {
+	if (m_type == json_type::NUMBER_ARRAY) return m_value.nums;
+	throw std::runtime_error{"Invalid type."};
+}
+
+json_node::packed_bool_type& json_node::get_packed_bools() {
+	if (m_type == json_type::BOOL_ARRAY) return m_value.bits;
+	throw std::runtime_error{"Invalid type."};
+}
+
+const json_node::packed_bool_type& json_node::get_packed_bools() const {
+	if (m_type == json_type::BOOL_ARRAY) return m_value.bits;
+	throw std::runtime_error{"Invalid type."};
+}
+
 std::string json_node::to_string() const {
-	return static_cast<std::stringstream&>(std::stringstream() << *this).str();
+	std::stringstream ss;
+	ss << *this;
+	return ss.str();
+}
+
+// Estimates the memory held by the node and its descendants from the
+// capacity of every string, vector and map node it owns, including the
+// node itself.
+
+std::size_t json_node::memory_usage() const noexcept {
+	std::size_t bytes = sizeof(json_node);
+	switch(m_type) {
+		case json_type::OBJECT:
+			for (const auto& member : m_value.obj) {
+				bytes += member_overhead + sizeof(string_type) + member.first.capacity();
+				bytes += member.second.memory_usage();
+			}
+			break;
+		case json_type::ARRAY:
+			bytes += (m_value.arr.capacity() - m_value.arr.size()) * sizeof(json_node);
+			for (const auto& element : m_value.arr) bytes += element.memory_usage();
+			break;
+		case json_type::STRING:
+			bytes += m_value.str.capacity();
+			break;
+		case json_type::NUMBER_ARRAY:
+			bytes += m_value.nums.capacity() * sizeof(number_type);
+			break;
+		case json_type::BOOL_ARRAY:
+			bytes += m_value.bits.capacity() * sizeof(packed_bool_type::value_type);
+			break;
+		default:
+			break;
+	}
+	return bytes;
+}
+
+namespace {
+
+std::size_t hash_combine(std::size_t p_seed, const std::size_t p_value) noexcept {
+	return p_seed ^ (p_value + 0x9e3779b97f4a7c15ull + (p_seed << 6) + (p_seed >> 2));
+}
+
+std::size_t hash_seed(const json_node::json_type p_type) noexcept {
+	return static_cast<std::size_t>(p_type) + 1;
+}
+
+std::size_t hash_number(const json_node::number_type p_num) noexcept {
+	return hash_combine(hash_seed(json_node::json_type::NUMBER), p_num == 0 ? 0 : std::hash<json_node::number_type>()(p_num));
+}
+
+std::size_t hash_bool(const json_node::bool_type p_boo) noexcept {
+	return hash_combine(hash_seed(json_node::json_type::BOOL), p_boo);
+}
+
+}
+
+// Walks the whole subtree on every call; callers that hash the same
+// immutable document repeatedly should keep the result, as
+// json_interner does. Packed arrays hash like the equivalent array of
+// nodes.
+
+std::size_t json_node::hash() const noexcept {
+	std::size_t result = hash_seed(is_array() ? json_type::ARRAY : m_type);
+	switch(m_type) {
+		case json_type::OBJECT:
+			for (const auto& member : m_value.obj) {
+				result = hash_combine(result, std::hash<string_type>()(member.first));
+				result = hash_combine(result, member.second.hash());
+			}
+			break;
+		case json_type::ARRAY:
+			for (const auto& element : m_value.arr) result = hash_combine(result, element.hash());
+			break;
+		case json_type::STRING:
+			result = hash_combine(result, std::hash<string_type>()(m_value.str));
+			break;
+		case json_type::NUMBER:
+			return hash_number(m_value.num);
+		case json_type::BOOL:
+			return hash_bool(m_value.boo);
+		case json_type::NONE:
+			break;
+		case json_type::NUMBER_ARRAY:
+			for (const auto num : m_value.nums) result = hash_combine(result, hash_number(num));
+			break;
+		case json_type::BOOL_ARRAY:
+			for (const auto bit : m_value.bits) result = hash_combine(result, hash_bool(bit));
+			break;
+	}
+	return result;
+}
+
+// Packed arrays compare equal to the equivalent array of nodes.
+
+bool json_node::operator==(const json_node& p_node) const noexcept {
+	if (this == &p_node) return true;
+	if (is_array() && p_node.is_array()) {
+		if (is_packed()) return packed_equals(p_node);
+		if (p_node.is_packed()) return p_node.packed_equals(*this);
+		return m_value.arr == p_node.m_value.arr;
+	}
+	if (m_type != p_node.m_type) return false;
+	switch(m_type) {
+		case json_type::OBJECT:
+			return m_value.obj == p_node.m_value.obj;
+		case json_type::ARRAY:
+			return m_value.arr == p_node.m_value.arr;
+		case json_type::STRING:
+			return m_value.str == p_node.m_value.str;
+		case json_type::NUMBER:
+			return m_value.num == p_node.m_value.num;
+		case json_type::BOOL:
+			return m_value.boo == p_node.m_value.boo;
+		default:
+			return true;
+	}
+}
+
+bool json_node::operator!=(const json_node& p_node) const noexcept {
+	return !(*this == p_node);
+}
+
+void swap(json_node& p_lhs, json_node& p_rhs) noexcept {
+	p_lhs.swap(p_rhs);
+}
+
+
+// Private json_node member functions:
+
+// Compares a packed array against any other array, element by element
+// where the storage differs.
+
+bool json_node::packed_equals(const json_node& p_node) const noexcept {
+	if (array_size() != p_node.array_size()) return false;
+	if (m_type == p_node.m_type) {
+		return m_type == json_type::NUMBER_ARRAY ? m_value.nums == p_node.m_value.nums : m_value.bits == p_node.m_value.bits;
+	}
+	if (p_node.m_type != json_type::ARRAY) return false;
+	for (array_type::size_type i = 0; i < p_node.m_value.arr.size(); ++i) {
+		const json_node& element = p_node.m_value.arr[i];
+		if (m_type == json_type::NUMBER_ARRAY) {
+			if (!element.is_number() || element.m_value.num != m_value.nums[i]) return false;
+		} else if (!element.is_bool() || element.m_value.boo != static_cast<bool_type>(m_value.bits[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void json_node::destroy() noexcept {
+	switch(m_type) {
+		case json_type::OBJECT:
+			m_value.obj.~object_type();
+			break;
+		case json_type::ARRAY:
+			m_value.arr.~array_type();
+			break;
+		case json_type::STRING:
+			m_value.str.~string_type();
+			break;
+		case json_type::NUMBER_ARRAY:
+			m_value.nums.~packed_number_type();
+			break;
+		case json_type::BOOL_ARRAY:
+			m_value.bits.~packed_bool_type();
+			break;
+		default:
+			break;
+	}
+}
+
+// Converts packed storage into an array of nodes so that references to
+// elements can be handed out. Does nothing for other types.
+
+void json_node::unpack() {
+	if (!is_packed()) return;
+	array_type arr;
+	arr.reserve(array_size());
+	if (m_type == json_type::NUMBER_ARRAY) {
+		for (const auto num : m_value.nums) arr.emplace_back(num);
+	} else {
+		for (const auto bit : m_value.bits) arr.emplace_back(static_cast<bool_type>(bit));
+	}
+	destroy();
+	new (&m_value.arr) array_type(std::move(arr));
+	m_type = json_type::ARRAY;
 }
 
 
@@ -324,7 +699,7 @@ json_node::json_value::json_value(const object_type& p_obj) {
 }
 
 json_node::json_value::json_value(const array_type& p_arr) {
-	new(&this->arr) array_type{p_arr};
+	new(&this->arr) array_type(p_arr);
 }
 
 json_node::json_value::json_value(const string_type& p_str) {
@@ -4,9 +4,15 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <map>
 #include <ostream>
+#include <stdexcept>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -21,7 +27,9 @@ public:
 		STRING,
 		NUMBER,
 		BOOL,
-		NONE
+		NONE,
+		NUMBER_ARRAY,
+		BOOL_ARRAY
 	};
 
 	using array_type = std::vector<json_node>;
@@ -29,29 +37,100 @@ public:
 	using object_type = std::map<string_type, json_node>;
 	using number_type = double;
 	using bool_type = bool;
+	using packed_number_type = std::vector<number_type>;
+	using packed_bool_type = std::vector<std::uint8_t>;
+
+	// A read-only element of an array in any representation. Elements
+	// of packed arrays are read straight from the buffer; elements of
+	// node arrays forward to the node.
+	class const_element {
+	public:
+		using size_type = array_type::size_type;
+
+		const_element(const json_node&, const size_type) noexcept;
+		bool is_object() const noexcept;
+		bool is_array() const noexcept;
+		bool is_string() const noexcept;
+		bool is_number() const noexcept;
+		bool is_bool() const noexcept;
+		bool is_null() const noexcept;
+		const object_type& get_object() const;
+		const string_type& get_string() const;
+		number_type get_number() const;
+		bool_type get_bool() const;
+		const json_node& get_node() const;
+
+	private:
+		const json_node* m_array;
+		size_type m_index;
+	};
+
+	class const_element_iterator {
+	public:
+		using size_type = array_type::size_type;
+		using difference_type = std::ptrdiff_t;
+		using value_type = const_element;
+		using pointer = void;
+		using reference = const_element;
+		using iterator_category = std::input_iterator_tag;
+
+		const_element_iterator(const json_node&, const size_type) noexcept;
+		reference operator*() const noexcept;
+		const_element_iterator& operator++() noexcept;
+		const_element_iterator operator++(int) noexcept;
+		bool operator==(const const_element_iterator&) const noexcept;
+		bool operator!=(const const_element_iterator&) const noexcept;
+
+	private:
+		const json_node* m_array;
+		size_type m_index;
+	};
+
+	class const_element_range {
+	public:
+		using size_type = array_type::size_type;
+
+		const_element_range(const json_node&);
+		const_element_iterator begin() const noexcept;
+		const_element_iterator end() const noexcept;
+		size_type size() const noexcept;
+		const_element operator[](const size_type) const noexcept;
+
+	private:
+		const json_node* m_array;
+		size_type m_size;
+	};
+
+	// Estimated bookkeeping bytes of each object member's tree node,
+	// beyond the key and value themselves.
+	static const std::size_t member_overhead;
 
 	json_node() noexcept = default;
 	json_node(const json_node&);
-	json_node(json_node&&);
+	json_node(json_node&&) noexcept;
 	json_node(const object_type&);
-	json_node(object_type&&);
+	json_node(object_type&&) noexcept;
 	json_node(const array_type&);
-	json_node(array_type&&);
+	json_node(array_type&&) noexcept;
 	json_node(const string_type&);
-	json_node(string_type&&);
+	json_node(string_type&&) noexcept;
 	json_node(const char* const);
 	json_node(const number_type);
 	json_node(const bool_type);
+	explicit json_node(const packed_number_type&);
+	explicit json_node(packed_number_type&&) noexcept;
+	explicit json_node(const packed_bool_type&);
+	explicit json_node(packed_bool_type&&) noexcept;
 	~json_node();
 	friend std::ostream& operator<<(std::ostream&, const json_node&);
 	json_node& operator=(const json_node&);
-	json_node& operator=(json_node&&);
+	json_node& operator=(json_node&&) noexcept;
 	json_node& operator=(const object_type&);
-	json_node& operator=(object_type&&);
+	json_node& operator=(object_type&&) noexcept;
 	json_node& operator=(const array_type&);
-	json_node& operator=(array_type&&);
+	json_node& operator=(array_type&&) noexcept;
 	json_node& operator=(const string_type&);
-	json_node& operator=(string_type&&);
+	json_node& operator=(string_type&&) noexcept;
 	json_node& operator=(const number_type&);
 	json_node& operator=(const bool_type&);
 	bool is_object() const noexcept;
@@ -60,17 +139,52 @@ public:
 	bool is_number() const noexcept;
 	bool is_bool() const noexcept;
 	bool is_null() const noexcept;
-	void nullify() noexcept [[noreturn]];
+	bool is_packed() const noexcept;
+	bool is_number_array() const noexcept;
+	bool is_bool_array() const noexcept;
+	void nullify() noexcept;
+	void swap(json_node&) noexcept;
+	void reserve(const array_type::size_type);
+	template <typename... Args>
+	json_node& emplace_back(Args&&...);
+	template <typename... Args>
+	std::pair<object_type::iterator, bool> emplace(const object_type::key_type&, Args&&...);
+	template <typename... Args>
+	std::pair<object_type::iterator, bool> emplace(object_type::key_type&&, Args&&...);
 	object_type& get_object();
+	const object_type& get_object() const;
 	array_type& get_array();
+	const array_type& get_array() const;
 	string_type& get_string();
+	const string_type& get_string() const;
 	number_type& get_number();
+	const number_type& get_number() const;
 	bool_type& get_bool();
+	const bool_type& get_bool() const;
 	json_node& get_node(const object_type::key_type&);
+	const json_node& get_node(const object_type::key_type&) const;
 	json_node& get_node(const array_type::size_type&);
+	const json_node& get_node(const array_type::size_type&) const;
+	array_type::size_type array_size() const;
+	number_type get_number(const array_type::size_type&) const;
+	bool_type get_bool(const array_type::size_type&) const;
+	const_element element(const array_type::size_type&) const;
+	const_element_range elements() const;
+	packed_number_type& get_packed_numbers();
+	const packed_number_type& get_packed_numbers() const;
+	packed_bool_type& get_packed_bools();
+	const packed_bool_type& get_packed_bools() const;
 	std::string to_string() const;
+	std::size_t memory_usage() const noexcept;
+	std::size_t hash() const noexcept;
+	bool operator==(const json_node&) const noexcept;
+	bool operator!=(const json_node&) const noexcept;
 
 private:
+	bool packed_equals(const json_node&) const noexcept;
+	void destroy() noexcept;
+	void unpack();
+
 	union json_value {
 		json_value() noexcept;
 		json_value(const object_type&);
@@ -84,8 +198,173 @@ private:
 		string_type str;
 		number_type num;
 		bool_type boo;
+		packed_number_type nums;
+		packed_bool_type bits;
 	} m_value;
 	json_type m_type{json_type::NONE};
 };
 
+void swap(json_node&, json_node&) noexcept;
+
+
+// Public json_node const_element member functions:
+
+inline json_node::const_element::const_element(const json_node& p_array, const size_type p_index) noexcept : m_array{&p_array}, m_index{p_index} {}
+
+inline bool json_node::const_element::is_object() const noexcept {
+	return m_array->m_type == json_type::ARRAY && m_array->m_value.arr[m_index].is_object();
+}
+
+inline bool json_node::const_element::is_array() const noexcept {
+	return m_array->m_type == json_type::ARRAY && m_array->m_value.arr[m_index].is_array();
+}
+
+inline bool json_node::const_element::is_string() const noexcept {
+	return m_array->m_type == json_type::ARRAY && m_array->m_value.arr[m_index].is_string();
+}
+
+inline bool json_node::const_element::is_number() const noexcept {
+	return m_array->m_type == json_type::NUMBER_ARRAY || (m_array->m_type == json_type::ARRAY && m_array->m_value.arr[m_index].is_number());
+}
+
+inline bool json_node::const_element::is_bool() const noexcept {
+	return m_array->m_type == json_type::BOOL_ARRAY || (m_array->m_type == json_type::ARRAY && m_array->m_value.arr[m_index].is_bool());
+}
+
+inline bool json_node::const_element::is_null() const noexcept {
+	return m_array->m_type == json_type::ARRAY && m_array->m_value.arr[m_index].is_null();
+}
+
+inline const json_node::object_type& json_node::const_element::get_object() const {
+	if (m_array->m_type == json_type::ARRAY) return m_array->m_value.arr[m_index].get_object();
+	throw std::runtime_error{"Invalid type."};
+}
+
+inline const json_node::string_type& json_node::const_element::get_string() const {
+	if (m_array->m_type == json_type::ARRAY) return m_array->m_value.arr[m_index].get_string();
+	throw std::runtime_error{"Invalid type."};
+}
+
+inline json_node::number_type json_node::const_element::get_number() const {
+	if (m_array->m_type == json_type::NUMBER_ARRAY) return m_array->m_value.nums[m_index];
+	if (m_array->m_type == json_type::ARRAY) return m_array->m_value.arr[m_index].get_number();
+	throw std::runtime_error{"Invalid type."};
+}
+
+inline json_node::bool_type json_node::const_element::get_bool() const {
+	if (m_array->m_type == json_type::BOOL_ARRAY) return m_array->m_value.bits[m_index] != 0;
+	if (m_array->m_type == json_type::ARRAY) return m_array->m_value.arr[m_index].get_bool();
+	throw std::runtime_error{"Invalid type."};
+}
+
+// Packed elements have no node of their own to refer to.
+
+inline const json_node& json_node::const_element::get_node() const {
+	if (m_array->m_type == json_type::ARRAY) return m_array->m_value.arr[m_index];
+	throw std::runtime_error{"Invalid operation."};
+}
+
+
+// Public json_node const_element_iterator member functions:
+
+inline json_node::const_element_iterator::const_element_iterator(const json_node& p_array, const size_type p_index) noexcept : m_array{&p_array}, m_index{p_index} {}
+
+inline json_node::const_element_iterator::reference json_node::const_element_iterator::operator*() const noexcept {
+	return const_element(*m_array, m_index);
+}
+
+inline json_node::const_element_iterator& json_node::const_element_iterator::operator++() noexcept {
+	++m_index;
+	return *this;
+}
+
+inline json_node::const_element_iterator json_node::const_element_iterator::operator++(int) noexcept {
+	const_element_iterator temp{*this};
+	++m_index;
+	return temp;
+}
+
+inline bool json_node::const_element_iterator::operator==(const const_element_iterator& p_rhs) const noexcept {
+	return m_array == p_rhs.m_array && m_index == p_rhs.m_index;
+}
+
+inline bool json_node::const_element_iterator::operator!=(const const_element_iterator& p_rhs) const noexcept {
+	return !(*this == p_rhs);
+}
+
+
+// Public json_node const_element_range member functions:
+
+inline json_node::const_element_range::const_element_range(const json_node& p_array) : m_array{&p_array}, m_size{p_array.array_size()} {}
+
+inline json_node::const_element_iterator json_node::const_element_range::begin() const noexcept {
+	return const_element_iterator(*m_array, 0);
+}
+
+inline json_node::const_element_iterator json_node::const_element_range::end() const noexcept {
+	return const_element_iterator(*m_array, m_size);
+}
+
+inline json_node::const_element_range::size_type json_node::const_element_range::size() const noexcept {
+	return m_size;
+}
+
+inline json_node::const_element json_node::const_element_range::operator[](const size_type p_pos) const noexcept {
+	return const_element(*m_array, p_pos);
+}
+
+
+// Public json_node member function templates:
+
+// Null nodes become empty arrays/objects on first emplacement so
+// that containers can be built in place without temporaries. Packed
+// arrays are unpacked first.
+
+template <typename... Args>
+json_node& json_node::emplace_back(Args&&... p_args) {
+	if (is_packed()) {
+		unpack();
+	} else if (m_type == json_type::NONE) {
+		new (&m_value.arr) array_type();
+		m_type = json_type::ARRAY;
+	} else if (m_type != json_type::ARRAY) {
+		throw std::runtime_error{"Invalid operation."};
+	}
+	m_value.arr.emplace_back(std::forward<Args>(p_args)...);
+	return m_value.arr.back();
+}
+
+template <typename... Args>
+std::pair<json_node::object_type::iterator, bool> json_node::emplace(const object_type::key_type& p_key, Args&&... p_args) {
+	if (m_type == json_type::NONE) {
+		new (&m_value.obj) object_type();
+		m_type = json_type::OBJECT;
+	} else if (m_type != json_type::OBJECT) {
+		throw std::runtime_error{"Invalid operation."};
+	}
+	return m_value.obj.emplace(std::piecewise_construct, std::forward_as_tuple(p_key), std::forward_as_tuple(std::forward<Args>(p_args)...));
+}
+
+template <typename... Args>
+std::pair<json_node::object_type::iterator, bool> json_node::emplace(object_type::key_type&& p_key, Args&&... p_args) {
+	if (m_type == json_type::NONE) {
+		new (&m_value.obj) object_type();
+		m_type = json_type::OBJECT;
+	} else if (m_type != json_type::OBJECT) {
+		throw std::runtime_error{"Invalid operation."};
+	}
+	return m_value.obj.emplace(std::piecewise_construct, std::forward_as_tuple(std::move(p_key)), std::forward_as_tuple(std::forward<Args>(p_args)...));
+}
+
+}
+
+namespace std {
+
+template <>
+struct hash<touchstone::json_node> {
+	std::size_t operator()(const touchstone::json_node& p_node) const noexcept {
+		return p_node.hash();
+	}
+};
+
 }
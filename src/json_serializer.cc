@@ -0,0 +1,280 @@
+#include "json_serializer.hh"
+
+#include "json_format.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace touchstone {
+
+namespace {
+
+using size_type = json_serializer::size_type;
+
+size_type measure(const json_node& p_node) {
+	char number[format::max_number_length];
+	if (p_node.is_object()) {
+		const json_node::object_type& obj = p_node.get_object();
+		size_type size = obj.empty() ? 2 : obj.size() + 1;
+		for (const auto& member : obj) size += format::quoted_size(member.first) + 1 + measure(member.second);
+		return size;
+	} else if (p_node.is_number_array()) {
+		const json_node::packed_number_type& nums = p_node.get_packed_numbers();
+		size_type size = nums.empty() ? 2 : nums.size() + 1;
+		for (const json_node::number_type num : nums) size += format::number(num, number);
+		return size;
+	} else if (p_node.is_bool_array()) {
+		const json_node::packed_bool_type& bits = p_node.get_packed_bools();
+		size_type size = bits.empty() ? 2 : bits.size() + 1;
+		for (const std::uint8_t bit : bits) size += bit ? 4 : 5;
+		return size;
+	} else if (p_node.is_array()) {
+		const json_node::array_type& arr = p_node.get_array();
+		size_type size = arr.empty() ? 2 : arr.size() + 1;
+		for (const json_node& element : arr) size += measure(element);
+		return size;
+	} else if (p_node.is_string()) {
+		return format::quoted_size(p_node.get_string());
+	} else if (p_node.is_number()) {
+		return format::number(p_node.get_number(), number);
+	} else if (p_node.is_bool()) {
+		return p_node.get_bool() ? 4 : 5;
+	}
+	return 4;
+}
+
+char* write_chars(const char* p_chars, const size_type p_size, char* p_out) {
+	std::memcpy(p_out, p_chars, p_size);
+	return p_out + p_size;
+}
+
+char* write_number(const json_node::number_type p_number, char* p_out) {
+	char number[format::max_number_length];
+	return write_chars(number, format::number(p_number, number), p_out);
+}
+
+char* write_bool(const bool p_bool, char* p_out) {
+	return p_bool ? write_chars("true", 4, p_out) : write_chars("false", 5, p_out);
+}
+
+char* write_key(const json_node::string_type& p_key, char* p_out) {
+	p_out = format::quote(p_key, p_out);
+	*p_out++ = ':';
+	return p_out;
+}
+
+char* write(const json_node& p_node, char* p_out) {
+	if (p_node.is_object()) {
+		*p_out++ = '{';
+		const json_node::object_type& obj = p_node.get_object();
+		for (auto it = obj.cbegin(); it != obj.cend(); ++it) {
+			if (it != obj.cbegin()) *p_out++ = ',';
+			p_out = write(it->second, write_key(it->first, p_out));
+		}
+		*p_out++ = '}';
+	} else if (p_node.is_number_array()) {
+		*p_out++ = '[';
+		const json_node::packed_number_type& nums = p_node.get_packed_numbers();
+		for (size_type i = 0; i < nums.size(); ++i) {
+			if (i) *p_out++ = ',';
+			p_out = write_number(nums[i], p_out);
+		}
+		*p_out++ = ']';
+	} else if (p_node.is_bool_array()) {
+		*p_out++ = '[';
+		const json_node::packed_bool_type& bits = p_node.get_packed_bools();
+		for (size_type i = 0; i < bits.size(); ++i) {
+			if (i) *p_out++ = ',';
+			p_out = write_bool(bits[i], p_out);
+		}
+		*p_out++ = ']';
+	} else if (p_node.is_array()) {
+		*p_out++ = '[';
+		const json_node::array_type& arr = p_node.get_array();
+		for (auto it = arr.cbegin(); it != arr.cend(); ++it) {
+			if (it != arr.cbegin()) *p_out++ = ',';
+			p_out = write(*it, p_out);
+		}
+		*p_out++ = ']';
+	} else if (p_node.is_string()) {
+		p_out = format::quote(p_node.get_string(), p_out);
+	} else if (p_node.is_number()) {
+		p_out = write_number(p_node.get_number(), p_out);
+	} else if (p_node.is_bool()) {
+		p_out = write_bool(p_node.get_bool(), p_out);
+	} else {
+		p_out = write_chars("null", 4, p_out);
+	}
+	return p_out;
+}
+
+bool is_container(const json_node& p_node) {
+	return p_node.is_object() || p_node.is_array();
+}
+
+size_type element_count(const json_node& p_node) {
+	return p_node.is_object() ? p_node.get_object().size() : p_node.array_size();
+}
+
+// Runs the function over [0, p_count) split into one contiguous range
+// per thread, joining before returning.
+
+template <typename Function>
+void run_parallel(const size_type p_count, const unsigned p_threads, Function p_function) {
+	const size_type threads = std::max<size_type>(1, std::min<size_type>(p_threads, p_count));
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	for (size_type i = 1; i < threads; ++i) {
+		workers.emplace_back(p_function, p_count * i / threads, p_count * (i + 1) / threads);
+	}
+	p_function(0, p_count / threads);
+	for (std::thread& worker : workers) worker.join();
+}
+
+}
+
+
+// Public json_serializer member functions:
+
+json_serializer::json_serializer(const json_node& p_node, const unsigned p_threads) : m_node(p_node), m_threads{p_threads ? p_threads : std::max(1u, std::thread::hardware_concurrency())} {
+	const json_node* node = &m_node;
+	while (is_container(*node)) {
+		m_path.push_back(node);
+		if (element_count(*node) != 1 || node->is_packed()) break;
+		const json_node& child = node->is_object() ? node->get_object().cbegin()->second : node->get_array().front();
+		if (!is_container(child)) break;
+		node = &child;
+	}
+	if (m_path.empty()) {
+		m_size = measure(m_node);
+		return;
+	}
+	for (const json_node* level : m_path) {
+		m_size += 2;
+		if (level != m_path.back() && level->is_object()) m_size += format::quoted_size(level->get_object().cbegin()->first) + 1;
+	}
+	const json_node& split = *m_path.back();
+	const size_type count = element_count(split);
+	if (split.is_object()) {
+		m_members.reserve(count);
+		for (auto it = split.get_object().cbegin(); it != split.get_object().cend(); ++it) m_members.push_back(it);
+	}
+	m_sizes.resize(count);
+	run_parallel(count, m_threads, [this](const size_type p_first, const size_type p_last) {
+		for (size_type i = p_first; i < p_last; ++i) m_sizes[i] = measure_element(i);
+	});
+	const size_type prefix = m_size - m_path.size();
+	size_type total = 0;
+	for (size_type i = 0; i < count; ++i) total += m_sizes[i] + (i ? 1 : 0);
+	m_size += total;
+	// Cut the elements into ranges of roughly equal output size.
+	size_type offset = prefix;
+	size_type first = 0;
+	size_type filled = 0;
+	for (size_type i = 0; i < count; ++i) {
+		filled += m_sizes[i] + (i ? 1 : 0);
+		if (i + 1 == count || filled * m_threads >= total * (m_ranges.size() + 1)) {
+			m_ranges.push_back(range{first, i + 1, offset});
+			offset = prefix + filled;
+			first = i + 1;
+		}
+	}
+}
+
+json_serializer::size_type json_serializer::size() const noexcept {
+	return m_size;
+}
+
+// Writes exactly size() bytes to the buffer.
+
+void json_serializer::write(char* p_out) const {
+	if (m_path.empty()) {
+		touchstone::write(m_node, p_out);
+		return;
+	}
+	char* out = p_out;
+	for (const json_node* level : m_path) {
+		*out++ = level->is_object() ? '{' : '[';
+		if (level != m_path.back() && level->is_object()) out = write_key(level->get_object().cbegin()->first, out);
+	}
+	run_parallel(m_ranges.size(), m_threads, [this, p_out](const size_type p_first, const size_type p_last) {
+		for (size_type r = p_first; r < p_last; ++r) {
+			char* out = p_out + m_ranges[r].offset;
+			for (size_type i = m_ranges[r].first; i < m_ranges[r].last; ++i) {
+				if (i) *out++ = ',';
+				out = write_element(i, out);
+			}
+		}
+	});
+	out = p_out + m_size;
+	for (const json_node* level : m_path) *--out = level->is_object() ? '}' : ']';
+}
+
+std::string json_serializer::to_string() const {
+	std::string result(m_size, '\0');
+	write(&result[0]);
+	return result;
+}
+
+// Writes the document to a file through a shared writable mapping,
+// sized up front with ftruncate.
+
+void json_serializer::write_file(const std::string& p_path) const {
+	const int fd = ::open(p_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd == -1) {
+		throw std::runtime_error{std::strerror(errno)};
+	}
+	if (!m_size) {
+		::close(fd);
+		return;
+	}
+	if (::ftruncate(fd, m_size) == -1) {
+		const int error = errno;
+		::close(fd);
+		throw std::runtime_error{std::strerror(error)};
+	}
+	void* mapping = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapping == MAP_FAILED) {
+		const int error = errno;
+		::close(fd);
+		throw std::runtime_error{std::strerror(error)};
+	}
+	try {
+		write(static_cast<char*>(mapping));
+	} catch (...) {
+		::munmap(mapping, m_size);
+		::close(fd);
+		throw;
+	}
+	::munmap(mapping, m_size);
+	::close(fd);
+}
+
+
+// Private json_serializer member functions:
+
+json_serializer::size_type json_serializer::measure_element(const size_type p_index) const {
+	const json_node& split = *m_path.back();
+	if (split.is_object()) return format::quoted_size(m_members[p_index]->first) + 1 + measure(m_members[p_index]->second);
+	char number[format::max_number_length];
+	if (split.is_number_array()) return format::number(split.get_packed_numbers()[p_index], number);
+	if (split.is_bool_array()) return split.get_packed_bools()[p_index] ? 4 : 5;
+	return measure(split.get_array()[p_index]);
+}
+
+char* json_serializer::write_element(const size_type p_index, char* p_out) const {
+	const json_node& split = *m_path.back();
+	if (split.is_object()) return touchstone::write(m_members[p_index]->second, write_key(m_members[p_index]->first, p_out));
+	if (split.is_number_array()) return write_number(split.get_packed_numbers()[p_index], p_out);
+	if (split.is_bool_array()) return write_bool(split.get_packed_bools()[p_index], p_out);
+	return touchstone::write(split.get_array()[p_index], p_out);
+}
+
+}
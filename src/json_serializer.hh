@@ -0,0 +1,52 @@
+#pragma once
+
+#include "json_node.hh"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace touchstone {
+
+// Serializes a document into one preallocated buffer, producing the
+// same bytes as operator<<: strings are escaped and numbers keep enough
+// digits to read back exactly. A sizing pass first measures the exact
+// output of every element of the document's widest container (found
+// by descending through single-element wrappers), and those sizes are
+// kept for later writes. Elements are then split into contiguous
+// ranges of roughly equal size and each range is written by its own
+// thread into a disjoint slice of the buffer. The document must not be
+// modified while a serializer refers to it.
+
+class json_serializer {
+public:
+	using size_type = std::size_t;
+
+	json_serializer(const json_node&, const unsigned = 0);
+	size_type size() const noexcept;
+	void write(char*) const;
+	std::string to_string() const;
+	void write_file(const std::string&) const;
+
+private:
+	struct range {
+		size_type first;
+		size_type last;
+		size_type offset;
+	};
+
+	size_type measure_element(const size_type) const;
+	char* write_element(const size_type, char*) const;
+
+	const json_node& m_node;
+	unsigned m_threads;
+	// Containers entered on the way down to the split node, which is
+	// the last of them.
+	std::vector<const json_node*> m_path;
+	std::vector<json_node::object_type::const_iterator> m_members;
+	std::vector<size_type> m_sizes;
+	std::vector<range> m_ranges;
+	size_type m_size{0};
+};
+
+}
@@ -0,0 +1,91 @@
+#include "node_pool.hh"
+
+#include <utility>
+
+namespace touchstone {
+
+// Public node_pool static member variables:
+
+const node_pool::size_type node_pool::max_spare_nodes{4096};
+const node_pool::size_type node_pool::max_spare_bytes{8 << 20};
+
+
+// Public node_pool member functions:
+
+node_pool& node_pool::local() noexcept {
+	static thread_local node_pool pool;
+	return pool;
+}
+
+void node_pool::recycle(json_node& p_node) {
+	std::vector<json_node>* spare = nullptr;
+	if (p_node.is_object()) {
+		json_node::object_type& obj = p_node.get_object();
+		for (auto& member : obj) recycle(member.second);
+		obj.clear();
+		spare = &m_objects;
+	} else if (p_node.is_array() && !p_node.is_packed()) {
+		json_node::array_type& arr = p_node.get_array();
+		for (auto& element : arr) recycle(element);
+		arr.clear();
+		spare = &m_arrays;
+	} else if (p_node.is_string()) {
+		spare = &m_strings;
+	}
+	if (spare && spare->size() < max_spare_nodes) {
+		const size_type bytes = p_node.memory_usage();
+		if (m_bytes + bytes <= max_spare_bytes) {
+			m_bytes += bytes;
+			spare->emplace_back(std::move(p_node));
+		}
+	}
+	p_node.nullify();
+}
+
+json_node::object_type& node_pool::make_object(json_node& p_node) {
+	if (p_node.is_object()) return p_node.get_object();
+	recycle(p_node);
+	if (!reuse(m_objects, p_node)) p_node = json_node::object_type();
+	return p_node.get_object();
+}
+
+json_node::array_type& node_pool::make_array(json_node& p_node) {
+	if (p_node.is_array() && !p_node.is_packed()) return p_node.get_array();
+	recycle(p_node);
+	if (!reuse(m_arrays, p_node)) p_node = json_node::array_type();
+	return p_node.get_array();
+}
+
+json_node::string_type& node_pool::make_string(json_node& p_node) {
+	if (p_node.is_string()) return p_node.get_string();
+	recycle(p_node);
+	if (!reuse(m_strings, p_node)) p_node = json_node::string_type();
+	return p_node.get_string();
+}
+
+void node_pool::clear() noexcept {
+	m_objects.clear();
+	m_arrays.clear();
+	m_strings.clear();
+	m_bytes = 0;
+}
+
+node_pool::size_type node_pool::size() const noexcept {
+	return m_objects.size() + m_arrays.size() + m_strings.size();
+}
+
+
+// Private node_pool member functions:
+
+// Moves the most recently recycled node of a kind into the given
+// (null) node, returning false if there is none.
+
+bool node_pool::reuse(std::vector<json_node>& p_spare, json_node& p_node) noexcept {
+	if (p_spare.empty()) return false;
+	m_bytes -= p_spare.back().memory_usage();
+	p_node.swap(p_spare.back());
+	p_spare.pop_back();
+	return true;
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "json_node.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace touchstone {
+
+// Per-thread free lists of json_node storage. Strings, arrays and
+// objects that fall out of a document are kept here with their
+// capacity intact so that subsequent parses can reuse them instead of
+// allocating. Containers are emptied on the way in, their children
+// being recycled one by one, and the pool holds at most
+// max_spare_nodes of each kind and max_spare_bytes in total.
+
+class node_pool {
+public:
+	using size_type = std::size_t;
+
+	static const size_type max_spare_nodes;
+	static const size_type max_spare_bytes;
+
+	static node_pool& local() noexcept;
+	node_pool(const node_pool&) = delete;
+	node_pool& operator=(const node_pool&) = delete;
+	void recycle(json_node&);
+	json_node::object_type& make_object(json_node&);
+	json_node::array_type& make_array(json_node&);
+	json_node::string_type& make_string(json_node&);
+	void clear() noexcept;
+	size_type size() const noexcept;
+
+private:
+	node_pool() = default;
+	bool reuse(std::vector<json_node>&, json_node&) noexcept;
+
+	std::vector<json_node> m_objects;
+	std::vector<json_node> m_arrays;
+	std::vector<json_node> m_strings;
+	size_type m_bytes{0};
+};
+
+}
@@ -0,0 +1,566 @@
+#pragma once
+
+#include "json_node.hh"
+#include "node_pool.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace touchstone {
+
+// Options controlling how documents are parsed. With pack_arrays set,
+// arrays made up entirely of numbers or entirely of booleans are stored
+// as packed buffers (see json_node::get_packed_numbers()) rather than
+// as arrays of nodes.
+//
+// The remaining options are limits, zero meaning unlimited. They are
+// checked as the input is consumed, so a document crossing one is
+// rejected at that point rather than after it has been read in full.
+// max_members applies to each object and array, and max_allocation to
+// the document's memory_usage() as estimated while it is built.
+// max_string_length applies to keys and string values only; the text
+// of a number is bounded by max_allocation and max_bytes. The parser recurses once per level of nesting, so
+// max_depth defaults to a depth that fits comfortably on a thread's
+// stack; setting it to zero lets deep input overflow the stack.
+
+struct parse_options {
+	bool pack_arrays{false};
+	std::size_t max_bytes{0};
+	std::size_t max_depth{512};
+	std::size_t max_string_length{0};
+	std::size_t max_members{0};
+	std::size_t max_allocation{0};
+};
+
+// Thrown when the input exceeds one of the limits in parse_options.
+
+class parse_limit_error : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+// Recursive descent parser over any pair of input iterators yielding
+// chars. Every value is parsed into an existing node, reusing the
+// storage it already holds where the shapes line up and drawing on
+// node_pool::local() where they do not, so parsing similarly shaped
+// messages into the same document allocates almost nothing once warm.
+
+template <typename InputIt>
+class json_parser {
+public:
+	json_parser(InputIt, InputIt, const parse_options& = parse_options());
+	json_node parse();
+	void parse_into(json_node&);
+	template <typename Function>
+	void parse_each(json_node&, Function);
+
+private:
+	struct scratch {
+		json_node::string_type key;
+		std::string number;
+		std::vector<const json_node*> members;
+	};
+
+	static scratch& local_scratch() noexcept;
+	static std::size_t limit(const std::size_t) noexcept;
+	[[noreturn]] void fail() const;
+	[[noreturn]] void exceed() const;
+	void charge(const std::size_t);
+	void enter();
+	bool at_end() const;
+	char peek() const;
+	char next();
+	void expect(const char);
+	void skip_whitespace();
+	void parse_value(json_node&);
+	void parse_object(json_node&);
+	void parse_array(json_node&);
+	bool parse_packed_numbers(json_node&);
+	bool parse_packed_bools(json_node&);
+	void parse_string(json_node::string_type&);
+	json_node::number_type parse_number();
+	void append_digit(std::string&, const std::size_t);
+	void parse_literal(const char* const);
+	void append_utf8(json_node::string_type&, unsigned long);
+	unsigned long parse_hex();
+
+	InputIt m_it;
+	InputIt m_end;
+	std::size_t m_pos{0};
+	node_pool& m_pool;
+	scratch& m_scratch;
+	parse_options m_options;
+	std::size_t m_max_bytes;
+	std::size_t m_max_depth;
+	std::size_t m_max_string_length;
+	std::size_t m_max_members;
+	std::size_t m_max_allocation;
+	std::size_t m_depth{0};
+	std::size_t m_allocated{0};
+};
+
+template <typename InputIt>
+json_node parse(InputIt, InputIt, const parse_options& = parse_options());
+
+template <typename InputIt>
+void parse_into(InputIt, InputIt, json_node&, const parse_options& = parse_options());
+
+
+// Public json_parser member functions:
+
+template <typename InputIt>
+json_parser<InputIt>::json_parser(InputIt p_first, InputIt p_last, const parse_options& p_options) : m_it{p_first}, m_end{p_last}, m_pool(node_pool::local()), m_scratch(local_scratch()), m_options(p_options), m_max_bytes{limit(p_options.max_bytes)}, m_max_depth{limit(p_options.max_depth)}, m_max_string_length{limit(p_options.max_string_length)}, m_max_members{limit(p_options.max_members)}, m_max_allocation{limit(p_options.max_allocation)} {}
+
+template <typename InputIt>
+json_node json_parser<InputIt>::parse() {
+	json_node node;
+	parse_into(node);
+	return node;
+}
+
+// On failure the document is left valid but its contents are
+// unspecified.
+
+template <typename InputIt>
+void json_parser<InputIt>::parse_into(json_node& p_node) {
+	m_scratch.members.clear();
+	skip_whitespace();
+	parse_value(p_node);
+	skip_whitespace();
+	if (!at_end()) fail();
+	if (m_pos > m_max_bytes) exceed();
+}
+
+
+// Parses a top-level array one element at a time into the same node,
+// calling the function with each, so that large arrays of records can
+// be consumed without building the whole document. Each element counts
+// as a document of its own against max_allocation, and the top-level
+// array is exempt from max_members.
+
+template <typename InputIt>
+template <typename Function>
+void json_parser<InputIt>::parse_each(json_node& p_node, Function p_function) {
+	m_scratch.members.clear();
+	skip_whitespace();
+	expect('[');
+	enter();
+	skip_whitespace();
+	if (peek() != ']') {
+		while (true) {
+			m_allocated = 0;
+			parse_value(p_node);
+			p_function(static_cast<const json_node&>(p_node));
+			skip_whitespace();
+			if (peek() == ']') break;
+			expect(',');
+			skip_whitespace();
+		}
+	}
+	++m_it;
+	++m_pos;
+	skip_whitespace();
+	if (!at_end()) fail();
+	if (m_pos > m_max_bytes) exceed();
+}
+
+
+// Private json_parser member functions:
+
+template <typename InputIt>
+typename json_parser<InputIt>::scratch& json_parser<InputIt>::local_scratch() noexcept {
+	static thread_local scratch buffers;
+	return buffers;
+}
+
+template <typename InputIt>
+std::size_t json_parser<InputIt>::limit(const std::size_t p_limit) noexcept {
+	return p_limit ? p_limit : std::numeric_limits<std::size_t>::max();
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::fail() const {
+	throw std::runtime_error{"Invalid syntax at offset " + std::to_string(m_pos) + '.'};
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::exceed() const {
+	throw parse_limit_error{"Parse limit exceeded at offset " + std::to_string(m_pos) + '.'};
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::charge(const std::size_t p_bytes) {
+	m_allocated += p_bytes;
+	if (m_allocated > m_max_allocation) exceed();
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::enter() {
+	if (++m_depth > m_max_depth) exceed();
+}
+
+template <typename InputIt>
+bool json_parser<InputIt>::at_end() const {
+	return !(m_it != m_end);
+}
+
+template <typename InputIt>
+char json_parser<InputIt>::peek() const {
+	if (at_end()) fail();
+	return *m_it;
+}
+
+template <typename InputIt>
+char json_parser<InputIt>::next() {
+	const char c = peek();
+	if (m_pos >= m_max_bytes) exceed();
+	++m_it;
+	++m_pos;
+	return c;
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::expect(const char p_char) {
+	if (next() != p_char) fail();
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::skip_whitespace() {
+	while (!at_end()) {
+		const char c = *m_it;
+		if (c != ' ' && c != '\n' && c != '\r' && c != '\t') return;
+		if (m_pos >= m_max_bytes) exceed();
+		++m_it;
+		++m_pos;
+	}
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::parse_value(json_node& p_node) {
+	switch (peek()) {
+		case '{':
+			parse_object(p_node);
+			return;
+		case '[':
+			parse_array(p_node);
+			return;
+		case '\"': {
+			json_node::string_type& str = m_pool.make_string(p_node);
+			str.clear();
+			parse_string(str);
+			return;
+		}
+		case 't':
+			parse_literal("true");
+			m_pool.recycle(p_node);
+			p_node = true;
+			return;
+		case 'f':
+			parse_literal("false");
+			m_pool.recycle(p_node);
+			p_node = false;
+			return;
+		case 'n':
+			parse_literal("null");
+			m_pool.recycle(p_node);
+			return;
+		default: {
+			const json_node::number_type num = parse_number();
+			m_pool.recycle(p_node);
+			p_node = num;
+		}
+	}
+}
+
+// Members already present in the object are parsed in place. Their
+// addresses are recorded on a shared stack so that members absent
+// from the input can be found and dropped once the object closes.
+
+template <typename InputIt>
+void json_parser<InputIt>::parse_object(json_node& p_node) {
+	json_node::object_type& obj = m_pool.make_object(p_node);
+	std::vector<const json_node*>& members = m_scratch.members;
+	const std::size_t base = members.size();
+	expect('{');
+	enter();
+	skip_whitespace();
+	std::size_t count = 0;
+	if (peek() != '}') {
+		while (true) {
+			if (++count > m_max_members) exceed();
+			charge(json_node::member_overhead + sizeof(json_node::object_type::value_type));
+			json_node::string_type& key = m_scratch.key;
+			key.clear();
+			parse_string(key);
+			auto it = obj.lower_bound(key);
+			if (it == obj.end() || it->first != key) {
+				it = obj.emplace_hint(it, key, json_node());
+			}
+			members.push_back(&it->second);
+			skip_whitespace();
+			expect(':');
+			skip_whitespace();
+			parse_value(it->second);
+			skip_whitespace();
+			if (peek() == '}') break;
+			expect(',');
+			skip_whitespace();
+		}
+	}
+	++m_it;
+	++m_pos;
+	std::sort(members.begin() + base, members.end());
+	members.erase(std::unique(members.begin() + base, members.end()), members.end());
+	if (members.size() - base != obj.size()) {
+		auto it = obj.begin();
+		while (it != obj.end()) {
+			if (std::binary_search(members.begin() + base, members.end(), &it->second)) {
+				++it;
+			} else {
+				m_pool.recycle(it->second);
+				it = obj.erase(it);
+			}
+		}
+	}
+	members.resize(base);
+	--m_depth;
+}
+
+// When packing, an array is parsed into a packed buffer for as long as
+// its elements match the first one; on the first mismatch the buffer
+// is unpacked and parsing carries on as a regular array.
+
+template <typename InputIt>
+void json_parser<InputIt>::parse_array(json_node& p_node) {
+	expect('[');
+	enter();
+	skip_whitespace();
+	bool unpacked = false;
+	if (m_options.pack_arrays) {
+		const char c = peek();
+		if (c == '-' || (c >= '0' && c <= '9')) {
+			if (parse_packed_numbers(p_node)) {
+				--m_depth;
+				return;
+			}
+			unpacked = true;
+		} else if (c == 't' || c == 'f') {
+			if (parse_packed_bools(p_node)) {
+				--m_depth;
+				return;
+			}
+			unpacked = true;
+		}
+	}
+	json_node::array_type& arr = unpacked ? p_node.get_array() : m_pool.make_array(p_node);
+	json_node::array_type::size_type count = unpacked ? arr.size() : 0;
+	if (unpacked) charge(count * sizeof(json_node));
+	if (unpacked || peek() != ']') {
+		while (true) {
+			if (count == m_max_members) exceed();
+			charge(sizeof(json_node));
+			if (count == arr.size()) arr.emplace_back();
+			parse_value(arr[count++]);
+			skip_whitespace();
+			if (peek() == ']') break;
+			expect(',');
+			skip_whitespace();
+		}
+	}
+	++m_it;
+	++m_pos;
+	while (arr.size() > count) {
+		m_pool.recycle(arr.back());
+		arr.pop_back();
+	}
+	--m_depth;
+}
+
+template <typename InputIt>
+bool json_parser<InputIt>::parse_packed_numbers(json_node& p_node) {
+	if (!p_node.is_number_array()) {
+		m_pool.recycle(p_node);
+		p_node = json_node(json_node::packed_number_type());
+	}
+	json_node::packed_number_type& nums = p_node.get_packed_numbers();
+	nums.clear();
+	while (true) {
+		if (nums.size() == m_max_members) exceed();
+		charge(sizeof(json_node::number_type));
+		nums.push_back(parse_number());
+		skip_whitespace();
+		if (peek() == ']') break;
+		expect(',');
+		skip_whitespace();
+		const char c = peek();
+		if (c != '-' && (c < '0' || c > '9')) return false;
+	}
+	expect(']');
+	return true;
+}
+
+template <typename InputIt>
+bool json_parser<InputIt>::parse_packed_bools(json_node& p_node) {
+	if (!p_node.is_bool_array()) {
+		m_pool.recycle(p_node);
+		p_node = json_node(json_node::packed_bool_type());
+	}
+	json_node::packed_bool_type& bits = p_node.get_packed_bools();
+	bits.clear();
+	while (true) {
+		if (bits.size() == m_max_members) exceed();
+		charge(sizeof(json_node::packed_bool_type::value_type));
+		if (peek() == 't') {
+			parse_literal("true");
+			bits.push_back(1);
+		} else {
+			parse_literal("false");
+			bits.push_back(0);
+		}
+		skip_whitespace();
+		if (peek() == ']') break;
+		expect(',');
+		skip_whitespace();
+		const char c = peek();
+		if (c != 't' && c != 'f') return false;
+	}
+	expect(']');
+	return true;
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::parse_string(json_node::string_type& p_str) {
+	expect('\"');
+	const std::size_t limit = std::min(m_max_string_length, m_max_allocation - m_allocated);
+	while (true) {
+		if (p_str.size() > limit) exceed();
+		const char c = next();
+		if (c == '\"') break;
+		if (static_cast<unsigned char>(c) < 0x20) fail();
+		if (c != '\\') {
+			p_str.push_back(c);
+			continue;
+		}
+		switch (next()) {
+			case '\"': p_str.push_back('\"'); break;
+			case '\\': p_str.push_back('\\'); break;
+			case '/': p_str.push_back('/'); break;
+			case 'b': p_str.push_back('\b'); break;
+			case 'f': p_str.push_back('\f'); break;
+			case 'n': p_str.push_back('\n'); break;
+			case 'r': p_str.push_back('\r'); break;
+			case 't': p_str.push_back('\t'); break;
+			case 'u': {
+				unsigned long code = parse_hex();
+				if (code >= 0xD800 && code < 0xDC00) {
+					expect('\\');
+					expect('u');
+					const unsigned long low = parse_hex();
+					if (low < 0xDC00 || low >= 0xE000) fail();
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				} else if (code >= 0xDC00 && code < 0xE000) {
+					fail();
+				}
+				append_utf8(p_str, code);
+				break;
+			}
+			default:
+				fail();
+		}
+	}
+	charge(p_str.size());
+}
+
+template <typename InputIt>
+json_node::number_type json_parser<InputIt>::parse_number() {
+	std::string& digits = m_scratch.number;
+	digits.clear();
+	const std::size_t limit = m_max_allocation - m_allocated;
+	if (peek() == '-') append_digit(digits, limit);
+	if (peek() == '0') {
+		append_digit(digits, limit);
+	} else if (peek() >= '1' && peek() <= '9') {
+		while (!at_end() && *m_it >= '0' && *m_it <= '9') append_digit(digits, limit);
+	} else {
+		fail();
+	}
+	if (!at_end() && *m_it == '.') {
+		append_digit(digits, limit);
+		if (peek() < '0' || peek() > '9') fail();
+		while (!at_end() && *m_it >= '0' && *m_it <= '9') append_digit(digits, limit);
+	}
+	if (!at_end() && (*m_it == 'e' || *m_it == 'E')) {
+		append_digit(digits, limit);
+		if (peek() == '+' || peek() == '-') append_digit(digits, limit);
+		if (peek() < '0' || peek() > '9') fail();
+		while (!at_end() && *m_it >= '0' && *m_it <= '9') append_digit(digits, limit);
+	}
+	return static_cast<json_node::number_type>(std::strtod(digits.c_str(), nullptr));
+}
+
+// The text of a number is buffered before conversion, so it counts
+// against the allocation limit while it is held.
+
+template <typename InputIt>
+void json_parser<InputIt>::append_digit(std::string& p_digits, const std::size_t p_limit) {
+	if (p_digits.size() >= p_limit) exceed();
+	p_digits.push_back(next());
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::parse_literal(const char* const p_literal) {
+	for (const char* c = p_literal; *c; ++c) expect(*c);
+}
+
+template <typename InputIt>
+void json_parser<InputIt>::append_utf8(json_node::string_type& p_str, unsigned long p_code) {
+	if (p_code < 0x80) {
+		p_str.push_back(static_cast<char>(p_code));
+	} else if (p_code < 0x800) {
+		p_str.push_back(static_cast<char>(0xC0 | (p_code >> 6)));
+		p_str.push_back(static_cast<char>(0x80 | (p_code & 0x3F)));
+	} else if (p_code < 0x10000) {
+		p_str.push_back(static_cast<char>(0xE0 | (p_code >> 12)));
+		p_str.push_back(static_cast<char>(0x80 | ((p_code >> 6) & 0x3F)));
+		p_str.push_back(static_cast<char>(0x80 | (p_code & 0x3F)));
+	} else {
+		p_str.push_back(static_cast<char>(0xF0 | (p_code >> 18)));
+		p_str.push_back(static_cast<char>(0x80 | ((p_code >> 12) & 0x3F)));
+		p_str.push_back(static_cast<char>(0x80 | ((p_code >> 6) & 0x3F)));
+		p_str.push_back(static_cast<char>(0x80 | (p_code & 0x3F)));
+	}
+}
+
+template <typename InputIt>
+unsigned long json_parser<InputIt>::parse_hex() {
+	unsigned long code = 0;
+	for (int i = 0; i < 4; ++i) {
+		const char c = next();
+		code <<= 4;
+		if (c >= '0' && c <= '9') code |= c - '0';
+		else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+		else fail();
+	}
+	return code;
+}
+
+
+// Parsing functions:
+
+template <typename InputIt>
+json_node parse(InputIt p_first, InputIt p_last, const parse_options& p_options) {
+	return json_parser<InputIt>(p_first, p_last, p_options).parse();
+}
+
+template <typename InputIt>
+void parse_into(InputIt p_first, InputIt p_last, json_node& p_node, const parse_options& p_options) {
+	json_parser<InputIt>(p_first, p_last, p_options).parse_into(p_node);
+}
+
+}
@@ -0,0 +1,172 @@
+#include "read_ahead.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace touchstone {
+
+// Public read_ahead static member variables:
+
+const read_ahead::size_type read_ahead::default_buffer_size{1 << 20};
+const read_ahead::size_type read_ahead::default_buffer_count{2};
+
+
+// Public read_ahead member functions:
+
+read_ahead::read_ahead(producer_type p_producer, const size_type p_buffer_size, const size_type p_buffer_count) : m_producer{std::move(p_producer)}, m_buffers(p_buffer_count < 2 ? 2 : p_buffer_count) {
+	for (auto& buf : m_buffers) buf.data.resize(p_buffer_size ? p_buffer_size : default_buffer_size);
+	m_thread = std::thread(&read_ahead::produce, this);
+}
+
+read_ahead::~read_ahead() {
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_stopping = true;
+	}
+	m_cond.notify_all();
+	m_thread.join();
+}
+
+read_ahead::const_iterator read_ahead::begin() {
+	return const_iterator(*this);
+}
+
+read_ahead::const_iterator read_ahead::end() noexcept {
+	return const_iterator();
+}
+
+// Hands the consumer the next filled buffer, returning the one it held
+// before to the producer. Returns false once the stream is exhausted.
+
+bool read_ahead::next_buffer(const char*& p_begin, const char*& p_end) {
+	std::unique_lock<std::mutex> lock{m_mutex};
+	if (m_started) ++m_consumed;
+	m_started = true;
+	m_cond.notify_all();
+	m_cond.wait(lock, [this] { return m_consumed < m_filled || m_finished; });
+	if (m_consumed == m_filled) {
+		if (m_error) std::rethrow_exception(m_error);
+		return false;
+	}
+	buffer& buf = m_buffers[m_consumed % m_buffers.size()];
+	p_begin = buf.data.data();
+	p_end = p_begin + buf.size;
+	return true;
+}
+
+
+// Private read_ahead member functions:
+
+// The buffer the consumer is reading stays counted as filled until it
+// asks for the next one, so the producer only ever writes to the rest.
+
+void read_ahead::produce() noexcept {
+	while (true) {
+		buffer* buf;
+		{
+			std::unique_lock<std::mutex> lock{m_mutex};
+			m_cond.wait(lock, [this] { return m_stopping || m_filled - m_consumed < m_buffers.size(); });
+			if (m_stopping) return;
+			buf = &m_buffers[m_filled % m_buffers.size()];
+		}
+		try {
+			buf->size = m_producer(buf->data.data(), buf->data.size());
+		} catch (...) {
+			buf->size = 0;
+			std::lock_guard<std::mutex> lock{m_mutex};
+			m_error = std::current_exception();
+		}
+		{
+			std::lock_guard<std::mutex> lock{m_mutex};
+			if (buf->size == 0) m_finished = true;
+			else ++m_filled;
+		}
+		m_cond.notify_all();
+		if (buf->size == 0) return;
+	}
+}
+
+
+// Public read_ahead const_iterator member functions:
+
+read_ahead::const_iterator::const_iterator(read_ahead& p_stream) : m_stream{&p_stream} {
+	if (!m_stream->next_buffer(m_pos, m_end)) m_stream = nullptr;
+}
+
+
+// Public file_stream member functions:
+
+file_stream::file_stream(const char* p_path, const size_type p_buffer_size, const size_type p_buffer_count) : m_file{p_path}, m_file_size{m_file.size()}, m_pipeline{[this](char* p_buf, size_type p_size) { return read(p_buf, p_size); }, p_buffer_size, p_buffer_count} {}
+
+file_stream::file_stream(const std::string& p_path, const size_type p_buffer_size, const size_type p_buffer_count) : file_stream{p_path.c_str(), p_buffer_size, p_buffer_count} {}
+
+file_stream::const_iterator file_stream::begin() {
+	return m_pipeline.begin();
+}
+
+file_stream::const_iterator file_stream::end() noexcept {
+	return m_pipeline.end();
+}
+
+file_stream::size_type file_stream::size() const noexcept {
+	return m_file_size;
+}
+
+
+// Private file_stream member functions:
+
+file_stream::size_type file_stream::read(char* p_buf, const size_type p_size) {
+	const size_type count = m_file.read(p_buf, p_size, m_offset);
+	m_offset += count;
+	return count;
+}
+
+
+// Public file_descriptor member functions:
+
+file_descriptor::file_descriptor(const char* p_path) {
+	if ((m_file_desc = open(p_path, O_RDONLY)) == -1) {
+		throw std::runtime_error{std::strerror(errno)};
+	}
+	posix_fadvise(m_file_desc, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+file_descriptor::~file_descriptor() {
+	close(m_file_desc);
+}
+
+// Reads until the buffer is full or the end of the file is reached.
+
+file_descriptor::size_type file_descriptor::read(char* p_buf, const size_type p_size, const size_type p_offset) {
+	size_type total = 0;
+	while (total < p_size) {
+		const ssize_t count = pread(m_file_desc, p_buf + total, p_size - total, p_offset + total);
+		if (count == -1) {
+			if (errno == EINTR) continue;
+			throw std::runtime_error{std::strerror(errno)};
+		}
+		if (count == 0) break;
+		total += count;
+	}
+	return total;
+}
+
+file_descriptor::size_type file_descriptor::size() const {
+	struct stat file_info;
+	if (fstat(m_file_desc, &file_info) == -1) {
+		throw std::runtime_error{std::strerror(errno)};
+	}
+	return file_info.st_size;
+}
+
+int file_descriptor::get() const noexcept {
+	return m_file_desc;
+}
+
+}
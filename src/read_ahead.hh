@@ -0,0 +1,178 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace touchstone {
+
+// Runs a producer on a background thread that fills a ring of
+// buffers ahead of the consumer, so that whatever the producer does
+// (reading, decompressing) overlaps with parsing on another core.
+// The producer writes at most the given number of bytes into the
+// buffer and returns how many it wrote; returning zero ends the
+// stream. Exceptions thrown by the producer are rethrown to the
+// consumer when it reaches the point of failure.
+
+class read_ahead {
+public:
+	using value_type = char;
+	using size_type = std::size_t;
+	using producer_type = std::function<size_type(char*, size_type)>;
+
+	class const_iterator {
+	public:
+		using difference_type = std::ptrdiff_t;
+		using value_type = const read_ahead::value_type;
+		using pointer = const char*;
+		using reference = const char&;
+		using iterator_category = std::input_iterator_tag;
+
+		const_iterator() noexcept = default;
+		const_iterator(read_ahead&);
+		reference operator*() const noexcept;
+		const_iterator& operator++();
+		const_iterator operator++(int);
+		const char* data() const noexcept;
+		size_type available() const noexcept;
+		const_iterator& skip(const size_type);
+		bool operator==(const const_iterator&) const noexcept;
+		bool operator!=(const const_iterator&) const noexcept;
+
+	private:
+		read_ahead* m_stream{nullptr};
+		const char* m_pos{nullptr};
+		const char* m_end{nullptr};
+	};
+
+	static const size_type default_buffer_size;
+	static const size_type default_buffer_count;
+
+	read_ahead(producer_type, const size_type = default_buffer_size, const size_type = default_buffer_count);
+	read_ahead(const read_ahead&) = delete;
+	read_ahead& operator=(const read_ahead&) = delete;
+	~read_ahead();
+	const_iterator begin();
+	const_iterator end() noexcept;
+	bool next_buffer(const char*&, const char*&);
+
+private:
+	struct buffer {
+		std::vector<char> data;
+		size_type size{0};
+	};
+
+	void produce() noexcept;
+
+	producer_type m_producer;
+	std::vector<buffer> m_buffers;
+	size_type m_filled{0};
+	size_type m_consumed{0};
+	bool m_started{false};
+	bool m_finished{false};
+	bool m_stopping{false};
+	std::exception_ptr m_error;
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::thread m_thread;
+};
+
+// Owns a read-only file descriptor opened for sequential access.
+
+class file_descriptor {
+public:
+	using size_type = std::size_t;
+
+	file_descriptor(const char*);
+	file_descriptor(const file_descriptor&) = delete;
+	file_descriptor& operator=(const file_descriptor&) = delete;
+	~file_descriptor();
+	size_type read(char*, const size_type, const size_type);
+	size_type size() const;
+	int get() const noexcept;
+
+private:
+	int m_file_desc;
+};
+
+// Streams a file through a read_ahead pipeline using pread, so that
+// disk reads for the next buffer overlap with parsing the current one.
+
+class file_stream {
+public:
+	using size_type = read_ahead::size_type;
+	using const_iterator = read_ahead::const_iterator;
+
+	file_stream(const char*, const size_type = read_ahead::default_buffer_size, const size_type = read_ahead::default_buffer_count);
+	file_stream(const std::string&, const size_type = read_ahead::default_buffer_size, const size_type = read_ahead::default_buffer_count);
+	file_stream(const file_stream&) = delete;
+	file_stream& operator=(const file_stream&) = delete;
+	const_iterator begin();
+	const_iterator end() noexcept;
+	size_type size() const noexcept;
+
+private:
+	size_type read(char*, const size_type);
+
+	// Declared ahead of the pipeline so the descriptor outlives the
+	// producer thread.
+	file_descriptor m_file;
+	size_type m_file_size;
+	size_type m_offset{0};
+	read_ahead m_pipeline;
+};
+
+
+// Public read_ahead const_iterator member functions:
+
+inline read_ahead::const_iterator::reference read_ahead::const_iterator::operator*() const noexcept {
+	return *m_pos;
+}
+
+inline read_ahead::const_iterator& read_ahead::const_iterator::operator++() {
+	if (++m_pos == m_end && !m_stream->next_buffer(m_pos, m_end)) {
+		m_stream = nullptr;
+	}
+	return *this;
+}
+
+inline read_ahead::const_iterator read_ahead::const_iterator::operator++(int) {
+	const_iterator temp{*this};
+	++*this;
+	return temp;
+}
+
+// The bytes from data() to data() + available() are contiguous, which
+// lets callers scan them in bulk before skipping past them.
+
+inline const char* read_ahead::const_iterator::data() const noexcept {
+	return m_pos;
+}
+
+inline read_ahead::size_type read_ahead::const_iterator::available() const noexcept {
+	return m_stream ? m_end - m_pos : 0;
+}
+
+inline read_ahead::const_iterator& read_ahead::const_iterator::skip(const size_type p_count) {
+	m_pos += p_count;
+	if (m_pos == m_end && !m_stream->next_buffer(m_pos, m_end)) {
+		m_stream = nullptr;
+	}
+	return *this;
+}
+
+inline bool read_ahead::const_iterator::operator==(const const_iterator& p_rhs) const noexcept {
+	return m_stream == p_rhs.m_stream && (!m_stream || m_pos == p_rhs.m_pos);
+}
+
+inline bool read_ahead::const_iterator::operator!=(const const_iterator& p_rhs) const noexcept {
+	return !(*this == p_rhs);
+}
+
+}
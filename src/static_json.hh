@@ -0,0 +1,616 @@
+#pragma once
+
+#include "json_node.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace touchstone {
+
+// Compile-time parsing of JSON literals. A static_json is parsed by its
+// constexpr constructor into a preorder table of entries and a buffer
+// of decoded strings. A counting pass over the literal sizes both
+// exactly, and the literal itself is not kept, so a document declared
+//
+//	static constexpr auto config = TOUCHSTONE_STATIC_JSON(R"({"port": 80})");
+//
+// is validated by the compiler and lives in read-only data with no
+// parse at startup. Malformed literals fail to compile, the error
+// pointing into the throwing check. Navigation mirrors the read-only
+// parts of json_node. Duplicate keys behave as in the runtime parser,
+// the last one winning. Numbers whose decimal mantissa fits in 53 bits
+// with a power of ten up to 22 are exact; others may differ from the
+// runtime parser in the last place.
+
+class static_string {
+public:
+	using size_type = std::size_t;
+
+	constexpr static_string(const char*) noexcept;
+	constexpr static_string(const char*, const size_type) noexcept;
+	constexpr const char* data() const noexcept;
+	constexpr size_type size() const noexcept;
+	constexpr char operator[](const size_type) const noexcept;
+	constexpr bool operator==(const static_string&) const noexcept;
+	constexpr bool operator!=(const static_string&) const noexcept;
+	std::string str() const;
+
+private:
+	const char* m_data;
+	size_type m_size;
+};
+
+struct static_entry {
+	using json_type = json_node::json_type;
+
+	json_type type{json_type::NONE};
+	// Set on object members overridden by a later duplicate key.
+	bool hidden{false};
+	std::uint32_t key_offset{0};
+	std::uint32_t key_size{0};
+	// Strings: offset and length of the text. Containers: index past
+	// the subtree and number of visible elements. Bools: the value.
+	std::uint32_t offset{0};
+	std::uint32_t size{0};
+	double number{0};
+};
+
+class static_node {
+public:
+	using json_type = json_node::json_type;
+	using size_type = std::size_t;
+
+	constexpr static_node(const static_entry*, const char*, const size_type) noexcept;
+	constexpr json_type type() const noexcept;
+	constexpr bool is_object() const noexcept;
+	constexpr bool is_array() const noexcept;
+	constexpr bool is_string() const noexcept;
+	constexpr bool is_number() const noexcept;
+	constexpr bool is_bool() const noexcept;
+	constexpr bool is_null() const noexcept;
+	constexpr size_type size() const;
+	constexpr static_node get_node(const static_string&) const;
+	constexpr static_node get_node(const size_type) const;
+	constexpr static_string get_string() const;
+	constexpr json_node::number_type get_number() const;
+	constexpr json_node::bool_type get_bool() const;
+	json_node to_node() const;
+
+private:
+	constexpr const static_entry& entry() const noexcept;
+	constexpr size_type next_sibling(const size_type) const noexcept;
+
+	const static_entry* m_nodes;
+	const char* m_strings;
+	size_type m_index;
+};
+
+// Numbers of entries and string bytes a literal parses into.
+
+struct static_json_size {
+	std::size_t nodes;
+	std::size_t chars;
+};
+
+// Parses a literal into caller-provided tables. With no tables it only
+// counts what they would need to hold.
+
+class static_parser {
+public:
+	using json_type = json_node::json_type;
+	using size_type = std::size_t;
+
+	// Bounds the constexpr recursion well inside the compiler's limit.
+	static constexpr size_type max_depth{128};
+
+	constexpr static_parser(const char*, const size_type, static_entry* = nullptr, const size_type = 0, char* = nullptr, const size_type = 0) noexcept;
+	constexpr static_json_size parse();
+
+private:
+	constexpr void require(const bool) const;
+	constexpr bool at_end() const noexcept;
+	constexpr char peek() const;
+	constexpr char next();
+	constexpr void expect(const char);
+	constexpr void skip_whitespace() noexcept;
+	constexpr static_entry& node(const size_type) noexcept;
+	constexpr void append(const char) noexcept;
+	constexpr void parse_value(const size_type);
+	constexpr void parse_container(const size_type, const bool, const size_type);
+	constexpr void parse_string(std::uint32_t&, std::uint32_t&);
+	constexpr json_node::number_type parse_number();
+	constexpr void parse_literal(const char*);
+	constexpr void append_utf8(unsigned long);
+	constexpr unsigned long parse_hex();
+	constexpr bool same_key(const size_type, const size_type) const noexcept;
+
+	const char* m_text;
+	size_type m_size;
+	size_type m_pos{0};
+	static_entry* m_nodes;
+	size_type m_node_capacity;
+	char* m_strings;
+	size_type m_string_capacity;
+	size_type m_count{0};
+	size_type m_string_size{0};
+	// Absorbs writes to entries past the capacity while counting.
+	static_entry m_scratch{};
+};
+
+template <std::size_t Nodes, std::size_t Chars>
+class static_json {
+public:
+	using size_type = std::size_t;
+
+	template <std::size_t N>
+	constexpr static_json(const char (&)[N]);
+	constexpr static_node root() const noexcept;
+	constexpr size_type node_count() const noexcept;
+
+private:
+	size_type m_count{0};
+	static_entry m_nodes[Nodes]{};
+	char m_strings[Chars ? Chars : 1]{};
+};
+
+template <std::size_t N>
+constexpr static_json_size measure_static_json(const char (&)[N]);
+
+// Declares a static_json sized exactly for the literal.
+
+#define TOUCHSTONE_STATIC_JSON(p_text) ::touchstone::static_json<::touchstone::measure_static_json(p_text).nodes, ::touchstone::measure_static_json(p_text).chars>(p_text)
+
+
+// Public static_string member functions:
+
+constexpr static_string::static_string(const char* p_data) noexcept : m_data{p_data}, m_size{0} {
+	while (p_data[m_size]) ++m_size;
+}
+
+constexpr static_string::static_string(const char* p_data, const size_type p_size) noexcept : m_data{p_data}, m_size{p_size} {}
+
+constexpr const char* static_string::data() const noexcept {
+	return m_data;
+}
+
+constexpr static_string::size_type static_string::size() const noexcept {
+	return m_size;
+}
+
+constexpr char static_string::operator[](const size_type p_pos) const noexcept {
+	return m_data[p_pos];
+}
+
+constexpr bool static_string::operator==(const static_string& p_rhs) const noexcept {
+	if (m_size != p_rhs.m_size) return false;
+	for (size_type i = 0; i < m_size; ++i) {
+		if (m_data[i] != p_rhs.m_data[i]) return false;
+	}
+	return true;
+}
+
+constexpr bool static_string::operator!=(const static_string& p_rhs) const noexcept {
+	return !(*this == p_rhs);
+}
+
+inline std::string static_string::str() const {
+	return std::string(m_data, m_size);
+}
+
+
+// Public static_node member functions:
+
+constexpr static_node::static_node(const static_entry* p_nodes, const char* p_strings, const size_type p_index) noexcept : m_nodes{p_nodes}, m_strings{p_strings}, m_index{p_index} {}
+
+constexpr static_node::json_type static_node::type() const noexcept {
+	return entry().type;
+}
+
+constexpr bool static_node::is_object() const noexcept {
+	return type() == json_type::OBJECT;
+}
+
+constexpr bool static_node::is_array() const noexcept {
+	return type() == json_type::ARRAY;
+}
+
+constexpr bool static_node::is_string() const noexcept {
+	return type() == json_type::STRING;
+}
+
+constexpr bool static_node::is_number() const noexcept {
+	return type() == json_type::NUMBER;
+}
+
+constexpr bool static_node::is_bool() const noexcept {
+	return type() == json_type::BOOL;
+}
+
+constexpr bool static_node::is_null() const noexcept {
+	return type() == json_type::NONE;
+}
+
+constexpr static_node::size_type static_node::size() const {
+	if (!is_object() && !is_array()) throw std::runtime_error{"Invalid type."};
+	return entry().size;
+}
+
+constexpr static_node static_node::get_node(const static_string& p_key) const {
+	if (!is_object()) throw std::runtime_error{"Invalid operation."};
+	for (size_type i = m_index + 1; i < entry().offset; i = next_sibling(i)) {
+		if (!m_nodes[i].hidden && static_string(m_strings + m_nodes[i].key_offset, m_nodes[i].key_size) == p_key) {
+			return static_node(m_nodes, m_strings, i);
+		}
+	}
+	throw std::out_of_range{"Invalid key."};
+}
+
+// Array elements are found by walking their preceding siblings.
+
+constexpr static_node static_node::get_node(const size_type p_pos) const {
+	if (!is_array()) throw std::runtime_error{"Invalid operation."};
+	if (p_pos >= entry().size) throw std::out_of_range{"Invalid index."};
+	size_type i = m_index + 1;
+	for (size_type skipped = 0; skipped < p_pos; ++skipped) i = next_sibling(i);
+	return static_node(m_nodes, m_strings, i);
+}
+
+constexpr static_string static_node::get_string() const {
+	if (!is_string()) throw std::runtime_error{"Invalid type."};
+	return static_string(m_strings + entry().offset, entry().size);
+}
+
+constexpr json_node::number_type static_node::get_number() const {
+	if (!is_number()) throw std::runtime_error{"Invalid type."};
+	return entry().number;
+}
+
+constexpr json_node::bool_type static_node::get_bool() const {
+	if (!is_bool()) throw std::runtime_error{"Invalid type."};
+	return entry().size != 0;
+}
+
+inline json_node static_node::to_node() const {
+	switch (type()) {
+		case json_type::OBJECT: {
+			json_node node{json_node::object_type()};
+			for (size_type i = m_index + 1; i < entry().offset; i = next_sibling(i)) {
+				if (m_nodes[i].hidden) continue;
+				node.emplace(json_node::string_type(m_strings + m_nodes[i].key_offset, m_nodes[i].key_size), static_node(m_nodes, m_strings, i).to_node());
+			}
+			return node;
+		}
+		case json_type::ARRAY: {
+			json_node node{json_node::array_type()};
+			node.reserve(entry().size);
+			for (size_type i = m_index + 1; i < entry().offset; i = next_sibling(i)) {
+				node.emplace_back(static_node(m_nodes, m_strings, i).to_node());
+			}
+			return node;
+		}
+		case json_type::STRING:
+			return json_node(get_string().str());
+		case json_type::NUMBER:
+			return json_node(get_number());
+		case json_type::BOOL:
+			return json_node(get_bool());
+		default:
+			return json_node();
+	}
+}
+
+
+// Private static_node member functions:
+
+constexpr const static_entry& static_node::entry() const noexcept {
+	return m_nodes[m_index];
+}
+
+constexpr static_node::size_type static_node::next_sibling(const size_type p_index) const noexcept {
+	const json_type type = m_nodes[p_index].type;
+	return type == json_type::OBJECT || type == json_type::ARRAY ? m_nodes[p_index].offset : p_index + 1;
+}
+
+
+// Public static_parser member functions:
+
+constexpr static_parser::static_parser(const char* p_text, const size_type p_size, static_entry* p_nodes, const size_type p_node_capacity, char* p_strings, const size_type p_string_capacity) noexcept : m_text{p_text}, m_size{p_size}, m_nodes{p_nodes}, m_node_capacity{p_node_capacity}, m_strings{p_strings}, m_string_capacity{p_string_capacity} {}
+
+constexpr static_json_size static_parser::parse() {
+	skip_whitespace();
+	parse_value(0);
+	skip_whitespace();
+	require(at_end());
+	return static_json_size{m_count, m_string_size};
+}
+
+
+// Public static_json member functions:
+
+template <std::size_t Nodes, std::size_t Chars>
+template <std::size_t N>
+constexpr static_json<Nodes, Chars>::static_json(const char (&p_text)[N]) {
+	const static_json_size size = static_parser(p_text, N - 1, m_nodes, Nodes, m_strings, Chars).parse();
+	if (size.nodes > Nodes || size.chars > Chars) throw std::length_error{"Literal exceeds static_json size."};
+	m_count = size.nodes;
+}
+
+template <std::size_t Nodes, std::size_t Chars>
+constexpr static_node static_json<Nodes, Chars>::root() const noexcept {
+	return static_node(m_nodes, m_strings, 0);
+}
+
+template <std::size_t Nodes, std::size_t Chars>
+constexpr typename static_json<Nodes, Chars>::size_type static_json<Nodes, Chars>::node_count() const noexcept {
+	return m_count;
+}
+
+
+// Private static_parser member functions:
+
+constexpr void static_parser::require(const bool p_condition) const {
+	if (!p_condition) throw std::runtime_error{"Invalid syntax."};
+}
+
+constexpr bool static_parser::at_end() const noexcept {
+	return m_pos >= m_size;
+}
+
+constexpr char static_parser::peek() const {
+	require(!at_end());
+	return m_text[m_pos];
+}
+
+constexpr char static_parser::next() {
+	const char c = peek();
+	++m_pos;
+	return c;
+}
+
+constexpr void static_parser::expect(const char p_char) {
+	require(next() == p_char);
+}
+
+constexpr void static_parser::skip_whitespace() noexcept {
+	while (!at_end() && (m_text[m_pos] == ' ' || m_text[m_pos] == '\n' || m_text[m_pos] == '\r' || m_text[m_pos] == '\t')) ++m_pos;
+}
+
+// Entries past the capacity are written to scratch when counting.
+
+constexpr static_entry& static_parser::node(const size_type p_index) noexcept {
+	return p_index < m_node_capacity ? m_nodes[p_index] : m_scratch;
+}
+
+constexpr void static_parser::append(const char p_char) noexcept {
+	if (m_string_size < m_string_capacity) m_strings[m_string_size] = p_char;
+	++m_string_size;
+}
+
+constexpr void static_parser::parse_value(const size_type p_depth) {
+	require(p_depth < max_depth);
+	const size_type index = m_count++;
+	static_entry& entry = node(index);
+	switch (peek()) {
+		case '{':
+			entry.type = json_type::OBJECT;
+			parse_container(index, true, p_depth);
+			break;
+		case '[':
+			entry.type = json_type::ARRAY;
+			parse_container(index, false, p_depth);
+			break;
+		case '\"':
+			entry.type = json_type::STRING;
+			parse_string(entry.offset, entry.size);
+			break;
+		case 't':
+			entry.type = json_type::BOOL;
+			entry.size = 1;
+			parse_literal("true");
+			break;
+		case 'f':
+			entry.type = json_type::BOOL;
+			parse_literal("false");
+			break;
+		case 'n':
+			parse_literal("null");
+			break;
+		default:
+			entry.type = json_type::NUMBER;
+			entry.number = parse_number();
+	}
+}
+
+constexpr void static_parser::parse_container(const size_type p_index, const bool p_object, const size_type p_depth) {
+	const char close = p_object ? '}' : ']';
+	next();
+	skip_whitespace();
+	std::uint32_t size = 0;
+	if (peek() != close) {
+		while (true) {
+			std::uint32_t key_offset = 0;
+			std::uint32_t key_size = 0;
+			if (p_object) {
+				require(peek() == '\"');
+				parse_string(key_offset, key_size);
+				skip_whitespace();
+				expect(':');
+				skip_whitespace();
+			}
+			const size_type member = m_count;
+			parse_value(p_depth + 1);
+			++size;
+			if (p_object) {
+				node(member).key_offset = key_offset;
+				node(member).key_size = key_size;
+				// Duplicates can only be found once the tables hold them.
+				if (m_count <= m_node_capacity && m_string_size <= m_string_capacity) {
+					for (size_type i = p_index + 1; i < member; i = m_nodes[i].type == json_type::OBJECT || m_nodes[i].type == json_type::ARRAY ? m_nodes[i].offset : i + 1) {
+						if (!m_nodes[i].hidden && same_key(i, member)) {
+							m_nodes[i].hidden = true;
+							--size;
+						}
+					}
+				}
+			}
+			skip_whitespace();
+			if (peek() == close) break;
+			expect(',');
+			skip_whitespace();
+		}
+	}
+	next();
+	node(p_index).offset = m_count;
+	node(p_index).size = size;
+}
+
+constexpr void static_parser::parse_string(std::uint32_t& p_offset, std::uint32_t& p_size) {
+	expect('\"');
+	p_offset = m_string_size;
+	while (true) {
+		const char c = next();
+		if (c == '\"') break;
+		require(static_cast<unsigned char>(c) >= 0x20);
+		if (c != '\\') {
+			append(c);
+			continue;
+		}
+		switch (next()) {
+			case '\"': append('\"'); break;
+			case '\\': append('\\'); break;
+			case '/': append('/'); break;
+			case 'b': append('\b'); break;
+			case 'f': append('\f'); break;
+			case 'n': append('\n'); break;
+			case 'r': append('\r'); break;
+			case 't': append('\t'); break;
+			case 'u': {
+				unsigned long code = parse_hex();
+				if (code >= 0xD800 && code < 0xDC00) {
+					expect('\\');
+					expect('u');
+					const unsigned long low = parse_hex();
+					require(low >= 0xDC00 && low < 0xE000);
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				} else {
+					require(code < 0xDC00 || code >= 0xE000);
+				}
+				append_utf8(code);
+				break;
+			}
+			default:
+				require(false);
+		}
+	}
+	p_size = m_string_size - p_offset;
+}
+
+constexpr json_node::number_type static_parser::parse_number() {
+	const bool negative = peek() == '-';
+	if (negative) next();
+	std::uint64_t mantissa = 0;
+	int digits = 0;
+	long exponent = 0;
+	require(peek() >= '0' && peek() <= '9');
+	if (peek() == '0') {
+		next();
+	} else {
+		while (!at_end() && m_text[m_pos] >= '0' && m_text[m_pos] <= '9') {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (next() - '0');
+				++digits;
+			} else {
+				next();
+				++exponent;
+			}
+		}
+	}
+	if (!at_end() && m_text[m_pos] == '.') {
+		next();
+		require(peek() >= '0' && peek() <= '9');
+		while (!at_end() && m_text[m_pos] >= '0' && m_text[m_pos] <= '9') {
+			const char c = next();
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (c - '0');
+				if (mantissa) ++digits;
+				--exponent;
+			}
+		}
+	}
+	if (!at_end() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E')) {
+		next();
+		bool negative_exponent = false;
+		if (peek() == '+' || peek() == '-') negative_exponent = next() == '-';
+		require(peek() >= '0' && peek() <= '9');
+		long value = 0;
+		while (!at_end() && m_text[m_pos] >= '0' && m_text[m_pos] <= '9') {
+			const char c = next();
+			if (value < 100000) value = value * 10 + (c - '0');
+		}
+		exponent += negative_exponent ? -value : value;
+	}
+	double result = static_cast<double>(mantissa);
+	if (mantissa && mantissa < (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+		double scale = 1;
+		for (long i = 0; i < (exponent < 0 ? -exponent : exponent); ++i) scale *= 10;
+		result = exponent < 0 ? result / scale : result * scale;
+	} else if (mantissa) {
+		for (; exponent > 0 && result < std::numeric_limits<double>::infinity(); --exponent) result *= 10;
+		for (; exponent < 0 && result > 0; ++exponent) result /= 10;
+	}
+	return negative ? -result : result;
+}
+
+constexpr void static_parser::parse_literal(const char* p_literal) {
+	for (; *p_literal; ++p_literal) expect(*p_literal);
+}
+
+constexpr void static_parser::append_utf8(unsigned long p_code) {
+	if (p_code < 0x80) {
+		append(static_cast<char>(p_code));
+	} else if (p_code < 0x800) {
+		append(static_cast<char>(0xC0 | (p_code >> 6)));
+		append(static_cast<char>(0x80 | (p_code & 0x3F)));
+	} else if (p_code < 0x10000) {
+		append(static_cast<char>(0xE0 | (p_code >> 12)));
+		append(static_cast<char>(0x80 | ((p_code >> 6) & 0x3F)));
+		append(static_cast<char>(0x80 | (p_code & 0x3F)));
+	} else {
+		append(static_cast<char>(0xF0 | (p_code >> 18)));
+		append(static_cast<char>(0x80 | ((p_code >> 12) & 0x3F)));
+		append(static_cast<char>(0x80 | ((p_code >> 6) & 0x3F)));
+		append(static_cast<char>(0x80 | (p_code & 0x3F)));
+	}
+}
+
+constexpr unsigned long static_parser::parse_hex() {
+	unsigned long code = 0;
+	for (int i = 0; i < 4; ++i) {
+		const char c = next();
+		code <<= 4;
+		if (c >= '0' && c <= '9') code |= c - '0';
+		else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+		else require(false);
+	}
+	return code;
+}
+
+constexpr bool static_parser::same_key(const size_type p_lhs, const size_type p_rhs) const noexcept {
+	return static_string(m_strings + m_nodes[p_lhs].key_offset, m_nodes[p_lhs].key_size) == static_string(m_strings + m_nodes[p_rhs].key_offset, m_nodes[p_rhs].key_size);
+}
+
+
+// Construction functions:
+
+// The literal's terminating null is excluded from the input.
+
+template <std::size_t N>
+constexpr static_json_size measure_static_json(const char (&p_text)[N]) {
+	return static_parser(p_text, N - 1).parse();
+}
+
+}
@@ -0,0 +1,40 @@
+#include "transform.hh"
+
+namespace touchstone {
+
+// Public output_buffer static member variables:
+
+const output_buffer::size_type output_buffer::default_capacity{1 << 16};
+
+
+// Public output_buffer member functions:
+
+output_buffer::output_buffer(std::ostream& p_stream, const size_type p_capacity) : m_stream(p_stream), m_buffer(p_capacity ? p_capacity : default_capacity) {}
+
+output_buffer::~output_buffer() {
+	flush();
+}
+
+void output_buffer::put(const char p_char) {
+	if (m_size == m_buffer.size()) flush();
+	m_buffer[m_size++] = p_char;
+}
+
+void output_buffer::write(const char* p_data, const size_type p_size) {
+	if (m_size + p_size > m_buffer.size()) {
+		flush();
+		if (p_size >= m_buffer.size()) {
+			m_stream.write(p_data, p_size);
+			return;
+		}
+	}
+	std::memcpy(m_buffer.data() + m_size, p_data, p_size);
+	m_size += p_size;
+}
+
+void output_buffer::flush() {
+	m_stream.write(m_buffer.data(), m_size);
+	m_size = 0;
+}
+
+}
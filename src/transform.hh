@@ -0,0 +1,432 @@
+#pragma once
+
+#include "read_ahead.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace touchstone {
+
+// Thrown by json_transformer on malformed input, so that callers can
+// tell it apart from failures of the input or output streams.
+
+class syntax_error : public std::runtime_error {
+public:
+	using std::runtime_error::runtime_error;
+};
+
+// Collects output in a fixed buffer and hands it to the stream in large
+// blocks. Flushed on destruction.
+
+class output_buffer {
+public:
+	using size_type = std::size_t;
+
+	static const size_type default_capacity;
+
+	output_buffer(std::ostream&, const size_type = default_capacity);
+	output_buffer(const output_buffer&) = delete;
+	output_buffer& operator=(const output_buffer&) = delete;
+	~output_buffer();
+	void put(const char);
+	void write(const char*, const size_type);
+	void flush();
+
+private:
+	std::ostream& m_stream;
+	std::vector<char> m_buffer;
+	size_type m_size{0};
+};
+
+// Streams a document from input to sink without building a tree,
+// validating it on the way and re-emitting it minified or indented.
+// Strings and numbers are copied verbatim. Nesting is tracked on an
+// explicit stack, so depth is bounded only by memory. Where the input
+// exposes contiguous bytes (plain pointers and read_ahead buffers),
+// string contents and whitespace are scanned eight bytes at a time.
+// The sink needs put(char) and write(const char*, std::size_t).
+
+template <typename InputIt, typename Sink>
+class json_transformer {
+public:
+	json_transformer(InputIt, InputIt, Sink&, const bool = false, const std::size_t = 4, const char = ' ');
+	void run();
+
+private:
+	enum class state {
+		VALUE,
+		KEY,
+		AFTER_VALUE
+	};
+
+	[[noreturn]] void fail() const;
+	bool at_end() const;
+	char peek() const;
+	char next();
+	void emit(const char);
+	void newline();
+	void advance(const std::size_t);
+	void skip_whitespace();
+	void copy_string();
+	void copy_number();
+	void copy_literal(const char* const);
+	bool is_digit() const;
+
+	InputIt m_it;
+	InputIt m_end;
+	Sink& m_sink;
+	std::size_t m_pos{0};
+	bool m_pretty;
+	std::size_t m_indent;
+	char m_indent_char;
+	std::vector<char> m_stack;
+};
+
+template <typename InputIt>
+bool validate(InputIt, InputIt);
+
+template <typename InputIt, typename Sink>
+void minify(InputIt, InputIt, Sink&);
+
+template <typename InputIt, typename Sink>
+void pretty_print(InputIt, InputIt, Sink&, const std::size_t = 4, const char = ' ');
+
+
+// Contiguous input scanning functions:
+
+namespace scan {
+
+const std::uint64_t ones{0x0101010101010101ull};
+const std::uint64_t highs{0x8080808080808080ull};
+
+// Sets the high bit of exactly those bytes of the word that are zero.
+
+inline std::uint64_t zero_bytes(const std::uint64_t p_word) noexcept {
+	return ~(((p_word & ~highs) + ~highs) | p_word | ~highs);
+}
+
+inline std::uint64_t equal_bytes(const std::uint64_t p_word, const unsigned char p_byte) noexcept {
+	return zero_bytes(p_word ^ (ones * p_byte));
+}
+
+inline std::uint64_t load(const char* p_pos) noexcept {
+	std::uint64_t word;
+	std::memcpy(&word, p_pos, sizeof(word));
+	return word;
+}
+
+inline bool is_whitespace(const char p_char) noexcept {
+	return p_char == ' ' || p_char == '\n' || p_char == '\r' || p_char == '\t';
+}
+
+inline bool is_special(const char p_char) noexcept {
+	return p_char == '\"' || p_char == '\\' || static_cast<unsigned char>(p_char) < 0x20;
+}
+
+// Returns the first quote, backslash or control character in the range,
+// or the end of the range if there is none.
+
+inline const char* find_special(const char* p_pos, const char* p_end) noexcept {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	while (p_end - p_pos >= 8) {
+		const std::uint64_t word = load(p_pos);
+		const std::uint64_t special = equal_bytes(word, '\"') | equal_bytes(word, '\\') | zero_bytes(word & (ones * 0xE0));
+		if (special) return p_pos + __builtin_ctzll(special) / 8;
+		p_pos += 8;
+	}
+#endif
+	while (p_pos != p_end && !is_special(*p_pos)) ++p_pos;
+	return p_pos;
+}
+
+// Returns the first character in the range that is not whitespace, or
+// the end of the range if there is none.
+
+inline const char* find_non_whitespace(const char* p_pos, const char* p_end) noexcept {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	while (p_end - p_pos >= 8) {
+		const std::uint64_t word = load(p_pos);
+		const std::uint64_t other = ~(equal_bytes(word, ' ') | equal_bytes(word, '\n') | equal_bytes(word, '\r') | equal_bytes(word, '\t')) & highs;
+		if (other) return p_pos + __builtin_ctzll(other) / 8;
+		p_pos += 8;
+	}
+#endif
+	while (p_pos != p_end && is_whitespace(*p_pos)) ++p_pos;
+	return p_pos;
+}
+
+// Exposes the contiguous bytes available at an iterator, if any.
+
+template <typename InputIt>
+std::pair<const char*, const char*> contiguous(const InputIt&, const InputIt&) noexcept {
+	return std::pair<const char*, const char*>(nullptr, nullptr);
+}
+
+inline std::pair<const char*, const char*> contiguous(const char* const& p_it, const char* const& p_end) noexcept {
+	return std::pair<const char*, const char*>(p_it, p_end);
+}
+
+inline std::pair<const char*, const char*> contiguous(char* const& p_it, char* const& p_end) noexcept {
+	return std::pair<const char*, const char*>(p_it, p_end);
+}
+
+inline std::pair<const char*, const char*> contiguous(const read_ahead::const_iterator& p_it, const read_ahead::const_iterator&) noexcept {
+	return std::pair<const char*, const char*>(p_it.data(), p_it.data() + p_it.available());
+}
+
+template <typename InputIt>
+void skip(InputIt& p_it, std::size_t p_count) {
+	while (p_count--) ++p_it;
+}
+
+inline void skip(const char*& p_it, const std::size_t p_count) noexcept {
+	p_it += p_count;
+}
+
+inline void skip(char*& p_it, const std::size_t p_count) noexcept {
+	p_it += p_count;
+}
+
+inline void skip(read_ahead::const_iterator& p_it, const std::size_t p_count) {
+	if (p_count) p_it.skip(p_count);
+}
+
+struct null_sink {
+	void put(const char) noexcept {}
+	void write(const char*, const std::size_t) noexcept {}
+};
+
+}
+
+
+// Public json_transformer member functions:
+
+template <typename InputIt, typename Sink>
+json_transformer<InputIt, Sink>::json_transformer(InputIt p_first, InputIt p_last, Sink& p_sink, const bool p_pretty, const std::size_t p_indent, const char p_indent_char) : m_it{p_first}, m_end{p_last}, m_sink(p_sink), m_pretty{p_pretty}, m_indent{p_indent}, m_indent_char{p_indent_char} {}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::run() {
+	state current = state::VALUE;
+	while (true) {
+		skip_whitespace();
+		switch (current) {
+			case state::VALUE: {
+				const char c = peek();
+				if (c == '{' || c == '[') {
+					emit(next());
+					skip_whitespace();
+					const char close = c == '{' ? '}' : ']';
+					if (peek() == close) {
+						emit(next());
+						current = state::AFTER_VALUE;
+					} else {
+						m_stack.push_back(close);
+						newline();
+						current = c == '{' ? state::KEY : state::VALUE;
+					}
+					break;
+				}
+				if (c == '\"') copy_string();
+				else if (c == 't') copy_literal("true");
+				else if (c == 'f') copy_literal("false");
+				else if (c == 'n') copy_literal("null");
+				else copy_number();
+				current = state::AFTER_VALUE;
+				break;
+			}
+			case state::KEY:
+				if (peek() != '\"') fail();
+				copy_string();
+				skip_whitespace();
+				if (next() != ':') fail();
+				emit(':');
+				if (m_pretty) emit(' ');
+				current = state::VALUE;
+				break;
+			case state::AFTER_VALUE: {
+				if (m_stack.empty()) {
+					if (!at_end()) fail();
+					return;
+				}
+				const char c = next();
+				if (c == ',') {
+					emit(',');
+					newline();
+					current = m_stack.back() == '}' ? state::KEY : state::VALUE;
+				} else if (c == m_stack.back()) {
+					m_stack.pop_back();
+					newline();
+					emit(c);
+				} else {
+					fail();
+				}
+				break;
+			}
+		}
+	}
+}
+
+
+// Private json_transformer member functions:
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::fail() const {
+	throw syntax_error{"Invalid syntax at offset " + std::to_string(m_pos) + '.'};
+}
+
+template <typename InputIt, typename Sink>
+bool json_transformer<InputIt, Sink>::at_end() const {
+	return !(m_it != m_end);
+}
+
+template <typename InputIt, typename Sink>
+char json_transformer<InputIt, Sink>::peek() const {
+	if (at_end()) fail();
+	return *m_it;
+}
+
+template <typename InputIt, typename Sink>
+char json_transformer<InputIt, Sink>::next() {
+	const char c = peek();
+	++m_it;
+	++m_pos;
+	return c;
+}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::emit(const char p_char) {
+	m_sink.put(p_char);
+}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::newline() {
+	if (!m_pretty) return;
+	m_sink.put('\n');
+	for (std::size_t i = m_stack.size() * m_indent; i > 0; --i) m_sink.put(m_indent_char);
+}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::advance(const std::size_t p_count) {
+	scan::skip(m_it, p_count);
+	m_pos += p_count;
+}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::skip_whitespace() {
+	while (!at_end()) {
+		const std::pair<const char*, const char*> span = scan::contiguous(m_it, m_end);
+		if (span.first) {
+			const char* stop = scan::find_non_whitespace(span.first, span.second);
+			if (stop == span.first) return;
+			advance(stop - span.first);
+		} else {
+			if (!scan::is_whitespace(*m_it)) return;
+			++m_it;
+			++m_pos;
+		}
+	}
+}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::copy_string() {
+	emit(next());
+	while (true) {
+		const std::pair<const char*, const char*> span = at_end() ? std::pair<const char*, const char*>(nullptr, nullptr) : scan::contiguous(m_it, m_end);
+		if (span.first) {
+			const char* stop = scan::find_special(span.first, span.second);
+			if (stop != span.first) {
+				m_sink.write(span.first, stop - span.first);
+				advance(stop - span.first);
+				continue;
+			}
+		}
+		const char c = next();
+		emit(c);
+		if (c == '\"') return;
+		if (static_cast<unsigned char>(c) < 0x20) fail();
+		if (c != '\\') continue;
+		const char escape = next();
+		emit(escape);
+		if (escape == 'u') {
+			for (int i = 0; i < 4; ++i) {
+				const char hex = next();
+				if (!((hex >= '0' && hex <= '9') || (hex >= 'a' && hex <= 'f') || (hex >= 'A' && hex <= 'F'))) fail();
+				emit(hex);
+			}
+		} else if (!std::strchr("\"\\/bfnrt", escape) || !escape) {
+			fail();
+		}
+	}
+}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::copy_number() {
+	if (peek() == '-') emit(next());
+	if (peek() == '0') {
+		emit(next());
+	} else if (is_digit()) {
+		while (!at_end() && is_digit()) emit(next());
+	} else {
+		fail();
+	}
+	if (!at_end() && *m_it == '.') {
+		emit(next());
+		if (!is_digit()) fail();
+		while (!at_end() && is_digit()) emit(next());
+	}
+	if (!at_end() && (*m_it == 'e' || *m_it == 'E')) {
+		emit(next());
+		if (peek() == '+' || peek() == '-') emit(next());
+		if (!is_digit()) fail();
+		while (!at_end() && is_digit()) emit(next());
+	}
+}
+
+template <typename InputIt, typename Sink>
+void json_transformer<InputIt, Sink>::copy_literal(const char* const p_literal) {
+	for (const char* c = p_literal; *c; ++c) {
+		if (next() != *c) fail();
+	}
+	m_sink.write(p_literal, std::strlen(p_literal));
+}
+
+template <typename InputIt, typename Sink>
+bool json_transformer<InputIt, Sink>::is_digit() const {
+	const char c = peek();
+	return c >= '0' && c <= '9';
+}
+
+
+// Transformation functions:
+
+// Errors raised by the input itself, such as a failed read, propagate
+// rather than being reported as invalid JSON.
+
+template <typename InputIt>
+bool validate(InputIt p_first, InputIt p_last) {
+	scan::null_sink sink;
+	try {
+		json_transformer<InputIt, scan::null_sink>(p_first, p_last, sink).run();
+	} catch (const syntax_error&) {
+		return false;
+	}
+	return true;
+}
+
+template <typename InputIt, typename Sink>
+void minify(InputIt p_first, InputIt p_last, Sink& p_sink) {
+	json_transformer<InputIt, Sink>(p_first, p_last, p_sink).run();
+}
+
+template <typename InputIt, typename Sink>
+void pretty_print(InputIt p_first, InputIt p_last, Sink& p_sink, const std::size_t p_indent, const char p_indent_char) {
+	json_transformer<InputIt, Sink>(p_first, p_last, p_sink, true, p_indent, p_indent_char).run();
+}
+
+}
@@ -0,0 +1,52 @@
+#include "read_ahead.hh"
+#include "transform.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+void print_usage(const char* name);
+
+int main(int argc, char* argv[]) {
+	using namespace touchstone;
+	if (argc != 3) {
+		print_usage(argv[0]);
+		return 2;
+	}
+	const std::string mode = argv[1];
+	std::ios_base::sync_with_stdio(false);
+	try {
+		file_stream stream(argv[2]);
+		if (mode == "--validate") {
+			if (validate(stream.begin(), stream.end())) return 0;
+			std::cerr << "Invalid JSON.\n";
+			return 1;
+		}
+		output_buffer sink(std::cout);
+		if (mode == "--minify") {
+			minify(stream.begin(), stream.end(), sink);
+		} else if (mode.compare(0, 8, "--pretty") == 0) {
+			std::size_t indent = 4;
+			if (mode.size() > 9 && mode[8] == '=') indent = std::strtoul(mode.c_str() + 9, nullptr, 10);
+			else if (mode.size() != 8) {
+				print_usage(argv[0]);
+				return 2;
+			}
+			pretty_print(stream.begin(), stream.end(), sink, indent);
+			sink.put('\n');
+		} else {
+			print_usage(argv[0]);
+			return 2;
+		}
+	} catch (const std::exception& e) {
+		std::cout.flush();
+		std::cerr << e.what() << '\n';
+		return 1;
+	}
+}
+
+void print_usage(const char* name) {
+	std::cerr << "Usage: " << name << " (--validate | --minify | --pretty[=indent]) file\n";
+}